@@ -0,0 +1,56 @@
+#include "BandActivityTracker.h"
+
+namespace MBRP_DSP
+{
+    void BandActivityTracker::prepare(double sampleRate, float silenceThresholdDb)
+    {
+        minQuietSamples = juce::roundToInt(sampleRate * minQuietTimeSeconds);
+        silenceThresholdGain = juce::Decibels::decibelsToGain(silenceThresholdDb, -200.0f);
+        reset();
+    }
+
+    void BandActivityTracker::reset()
+    {
+        state = State::active;
+        samplesSinceSilenced = 0;
+        quietSamples = 0;
+    }
+
+    bool BandActivityTracker::beginBlock(bool isSilenced) noexcept
+    {
+        if (!isSilenced)
+        {
+            // Пробуждение: DSP был сброшен при засыпании, просто продолжаем обработку
+            state = State::active;
+            return true;
+        }
+
+        if (state == State::active)
+        {
+            state = State::draining;
+            samplesSinceSilenced = 0;
+            quietSamples = 0;
+        }
+
+        return state != State::sleeping;
+    }
+
+    bool BandActivityTracker::endBlock(float outputPeak, int numSamples, int pendingDelaySamples) noexcept
+    {
+        if (state != State::draining)
+            return false;
+
+        samplesSinceSilenced += numSamples;
+        quietSamples = (outputPeak < silenceThresholdGain) ? quietSamples + numSamples : 0;
+
+        // Засыпаем, только когда всё, что было в линии задержки, уже прошло через реверб,
+        // и выход был тихим дольше самой длинной гребенки
+        if (samplesSinceSilenced > pendingDelaySamples && quietSamples >= minQuietSamples)
+        {
+            state = State::sleeping;
+            return true;
+        }
+
+        return false;
+    }
+}
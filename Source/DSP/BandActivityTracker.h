@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Отслеживает, нужно ли вообще обрабатывать полосу.
+    // Полоса, заглушенная Mute или "выключенная" чужим Solo, сначала дозвучивает
+    // (пре-дилей + хвост реверба), а когда её выход держится ниже порога
+    // достаточно долго - засыпает: микшер, задержка и гейн для неё не вызываются,
+    // а её линия MultiBandReverb становится пустой. Сам векторный реверб стоит одинаково
+    // при 1 и 4 занятых линиях и пропускается, только когда спят все полосы его группы.
+    // При засыпании вызывающая сторона сбрасывает DSP-состояние полосы,
+    // поэтому после пробуждения обработка начинается с чистого состояния.
+    class BandActivityTracker
+    {
+    public:
+        enum class State { active, draining, sleeping };
+
+        static constexpr float defaultSilenceThresholdDb = -100.0f;
+        static constexpr double minQuietTimeSeconds = 0.05; // больше самой длинной гребенки Freeverb
+
+        void prepare(double sampleRate, float silenceThresholdDb = defaultSilenceThresholdDb);
+        void reset();
+
+        // Вызывается в начале блока. Возвращает false, если полосу можно пропустить целиком.
+        bool beginBlock(bool isSilenced) noexcept;
+
+        // Вызывается после обработки полосы (только если beginBlock вернул true).
+        // outputPeak - пиковый уровень выхода полосы за блок,
+        // pendingDelaySamples - текущий пре-дилей (сигнал, еще "летящий" в линии задержки).
+        // Возвращает true, если полоса только что заснула и её DSP нужно сбросить.
+        bool endBlock(float outputPeak, int numSamples, int pendingDelaySamples) noexcept;
+
+        State getState() const noexcept { return state; }
+        bool isSleeping() const noexcept { return state == State::sleeping; }
+
+    private:
+        State state = State::active;
+        int samplesSinceSilenced = 0;
+        int quietSamples = 0;
+        int minQuietSamples = 2205;
+        float silenceThresholdGain = juce::Decibels::decibelsToGain(defaultSilenceThresholdDb, -200.0f);
+    };
+}
@@ -0,0 +1,11 @@
+#include "BandProcessor.h"
+
+namespace MBRP_DSP
+{
+    // Процессор собирает только BandProcessor<4>. Остальные размеры из допустимого
+    // диапазона 2..8 инстанцируются явно, чтобы пути с одной неполной группой
+    // реверба (2) и с несколькими группами (6, 8) проверялись компилятором.
+    template class BandProcessor<2>;
+    template class BandProcessor<6>;
+    template class BandProcessor<8>;
+}
@@ -0,0 +1,636 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "BandActivityTracker.h"
+#include "HalfBandResampler.h"
+#include "MultiBandReverb.h"
+#include "ParameterRamp.h"
+#include "PreDelayLines.h"
+#include "RealtimeThreadPool.h"
+#include "SharedSpaceReverb.h"
+#include "StereoMatrixMixer.h"
+
+namespace MBRP_DSP
+{
+    // Движок реверба: полная сеть на полосу или общее пространство (см. SharedSpaceReverb)
+    enum class ReverbMode { perBand = 0, sharedSpace };
+
+    //==============================================================================
+    // Обработка полос после кроссовера: Solo/Mute, пре-дилей, реверб, Wet, гейн и панорама
+    // со сведением в стерео-выход. Число полос задается при компиляции (2..8).
+    //
+    // Состояние хранится структурой массивов: одно поле всех полос лежит подряд
+    // (рампы, линии задержки, флаги), циклы по полосам имеют длину NumBands
+    // и разворачиваются компилятором. Полосы реверба - линии MultiBandReverb,
+    // по MultiBandReverb::numLanes полос на экземпляр.
+    //
+    // Сеттеры и process() - только аудиопоток (или поток, владеющий обработкой).
+    template <int NumBands>
+    class BandProcessor
+    {
+    public:
+        static constexpr int numBands = NumBands;
+        static constexpr int numChannels = 2;
+        static constexpr int numReverbGroups = (NumBands + MultiBandReverb::numLanes - 1) / MultiBandReverb::numLanes;
+
+        static_assert(NumBands >= 2 && NumBands <= 8, "От 2 до 8 полос");
+        static_assert(NumBands <= StereoMatrixMixer::maxInputs, "Вход сведения на каждую полосу");
+        static_assert(NumBands <= SharedSpaceReverb::maxBands, "Ранние отражения на каждую полосу");
+
+        // Постоянные времени сглаживания в мс, от размера блока хоста не зависят
+        static constexpr float panRampMs = 20.0f;      // linear, гейны L/R после закона панорамы
+        static constexpr float gainRampMs = 20.0f;     // linear, линейный гейн полосы
+        static constexpr float preDelayRampMs = 50.0f; // exponential, пре-дилей в отсчетах
+        static constexpr float wetRampMs = 50.0f;      // linear, доля wet полосы
+        static constexpr double reverbSmoothingSeconds = 0.05; // roomSize/damping внутри движков реверба
+        static constexpr float defaultMaxPreDelayMs = 1000.0f; // Верхняя граница параметров Pre-Delay
+        static constexpr double minDecimatedSampleRate = 11025.0; // Низкая полоса: не ниже этой частоты
+
+        BandProcessor()
+        {
+            for (int band = 0; band < NumBands; ++band)
+                applyReverbParameters(band);
+        }
+
+        // Рампы стартуют сразу с заданных до prepare() значений (без скольжения)
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            jassert(spec.numChannels == (juce::uint32)numChannels);
+            sampleRate = spec.sampleRate;
+            maxBlockSize = (int)spec.maximumBlockSize;
+
+            // Раскладка полос по движкам: память ниже выделяется только под нее
+            const int factor = getMultirateFactor(sampleRate);
+            reverbMode = requestedReverbMode;
+            lowBandMultirate = lowBandMultirateRequested && reverbMode == ReverbMode::perBand && factor > 1;
+            firstGroupBand = lowBandMultirate ? 1 : 0;
+            numActiveReverbGroups = reverbMode == ReverbMode::perBand
+                ? (NumBands - firstGroupBand + MultiBandReverb::numLanes - 1) / MultiBandReverb::numLanes : 0;
+
+            // Пре-дилей всех полос - одна область памяти по фактической частоте и диапазону параметра.
+            // Последняя линия - полоса 0 на пониженной частоте; тогда полноскоростной линии у нее нет.
+            const int maxDelay = juce::jmax(1, (int)std::ceil(maxPreDelayMs * 0.001 * sampleRate));
+            std::vector<int> maxDelays((size_t)NumBands + 1, maxDelay);
+            maxDelays[0] = lowBandMultirate ? 0 : maxDelay;
+            maxDelays[(size_t)lowBandLine] = lowBandMultirate ? maxDelay / factor + 1 : 0;
+            preDelays.prepare(maxDelays, maxBlockSize);
+
+            using RampType = ParameterRamp::Type;
+            for (size_t band = 0; band < (size_t)NumBands; ++band)
+            {
+                bandBuffers[band].setSize(numChannels, maxBlockSize, false, true, true);
+
+                leftPanRamps[band].prepare(sampleRate, maxBlockSize, panRampMs, RampType::linear);
+                rightPanRamps[band].prepare(sampleRate, maxBlockSize, panRampMs, RampType::linear);
+                gainRamps[band].prepare(sampleRate, maxBlockSize, gainRampMs, RampType::linear);
+                wetRamps[band].prepare(sampleRate, maxBlockSize, wetRampMs, RampType::linear);
+                preDelayRamps[band].prepare(sampleRate, maxBlockSize, preDelayRampMs, RampType::exponential);
+                preDelayRamps[band].setCurrentAndTarget(getPreDelaySamples((int)band)); // Отсчеты зависят от частоты
+
+                activity[band].prepare(sampleRate);
+            }
+            rampBuffer.setSize(1, maxBlockSize, false, true, true);
+            reverbIdle.fill(false);
+
+            // Линии групп могли смениться вместе с раскладкой.
+            // prepare() после setParameters: сглаживание стартует сразу с начальных значений
+            for (int band = 0; band < NumBands; ++band)
+                applyReverbParameters(band);
+
+            for (int g = 0; g < numReverbGroups; ++g)
+            {
+                auto& reverb = reverbs[(size_t)g];
+                if (g < numActiveReverbGroups)
+                {
+                    reverb.setSmoothingTime(reverbSmoothingSeconds);
+                    reverb.prepare(spec);
+                    reverb.reset();
+                }
+                else
+                {
+                    reverb.release();
+                }
+            }
+
+            if (reverbMode == ReverbMode::sharedSpace)
+            {
+                sharedSpace.setSmoothingTime(reverbSmoothingSeconds);
+                sharedSpace.prepare(spec);
+                sharedSpace.reset();
+            }
+            else
+            {
+                sharedSpace.release();
+            }
+
+            // Низкая полоса на пониженной частоте: ее линия задержки и сеть реверба в factor раз меньше
+            if (lowBandMultirate)
+            {
+                const juce::dsp::ProcessSpec lowSpec{ sampleRate / factor, (juce::uint32)(maxBlockSize / factor + 1), (juce::uint32)numChannels };
+                lowBandResampler.prepare(factor, maxBlockSize);
+                lowBandReverb.setSmoothingTime(reverbSmoothingSeconds);
+                lowBandReverb.prepare(lowSpec);
+                resetLowBand();
+            }
+            else
+            {
+                lowBandReverb.release();
+            }
+        }
+
+        // Сброс всего состояния обработки (хвосты уже затихли, так что щелчков нет)
+        void reset()
+        {
+            for (int g = 0; g < numActiveReverbGroups; ++g)
+                reverbs[(size_t)g].reset();
+            if (reverbMode == ReverbMode::sharedSpace)
+                sharedSpace.reset();
+            if (lowBandMultirate)
+                resetLowBand();
+
+            preDelays.reset();
+            reverbIdle.fill(false);
+        }
+
+        // Буфер полосы: кроссовер пишет сюда, process() обрабатывает на месте
+        juce::AudioBuffer<float>& getBandBuffer(int band) noexcept { return bandBuffers[(size_t)band]; }
+
+        //==============================================================================
+        // pan: -1..1, закон равной мощности
+        static void getPanGains(float pan, float& left, float& right) noexcept
+        {
+            constexpr float piOverTwo = juce::MathConstants<float>::pi * 0.5f;
+            const float angle = (pan * 0.5f + 0.5f) * piOverTwo;
+            left = std::cos(angle);
+            right = std::sin(angle);
+        }
+
+        // Сглаживаются уже сами гейны L/R
+        void setPan(int band, float pan) noexcept
+        {
+            float left, right;
+            getPanGains(pan, left, right);
+            leftPanRamps[(size_t)band].setTarget(left);
+            rightPanRamps[(size_t)band].setTarget(right);
+        }
+
+        void setGain(int band, float gainLinear) noexcept
+        {
+            gainRamps[(size_t)band].setTarget(gainLinear);
+            updateSend(band);
+        }
+
+        // Только новые цели. Сглаживание по отсчетам делают сами модули:
+        // roomSize/damping - MultiBandReverb/SharedSpaceReverb, wet - wetRamps, пре-дилей - preDelayRamps.
+        void setReverb(int band, float wet, float roomSize, float damping, float preDelayMilliseconds) noexcept
+        {
+            const auto b = (size_t)band;
+            wetTargets[b] = wet;
+            roomSizes[b] = roomSize;
+            dampings[b] = damping;
+            preDelayMs[b] = preDelayMilliseconds;
+
+            applyReverbParameters(band);
+            updateSend(band);
+            preDelayRamps[b].setTarget(getPreDelaySamples(band));
+            wetRamps[b].setTarget(wet);
+        }
+
+        // Байпас: панорама и Wet не применяются, полоса идет в выход с гейном.
+        // Пре-дилей и линия реверба полосы при этом один раз сбрасываются (см. reverbIdle),
+        // после снятия байпаса реверб стартует с тишины. Раньше невызываемый juce::Reverb
+        // замораживал хвост, и тот доигрывал после снятия байпаса.
+        void setBypassed(int band, bool shouldBeBypassed) noexcept { bypassed[(size_t)band] = shouldBeBypassed; }
+
+        // Mute или чужой Solo: полоса дозвучивает хвост и засыпает
+        void setSilenced(int band, bool shouldBeSilenced) noexcept { silenced[(size_t)band] = shouldBeSilenced; }
+
+        // Применяется в prepare(): память выделяется только под выбранный движок
+        void setReverbMode(ReverbMode newMode) noexcept { requestedReverbMode = newMode; }
+        ReverbMode getReverbMode() const noexcept { return reverbMode; }
+
+        // Наибольший пре-дилей (верхняя граница параметров), по нему память линий. Применяется в prepare().
+        void setMaxPreDelay(float milliseconds) noexcept { maxPreDelayMs = juce::jmax(0.0f, milliseconds); }
+
+        // Пре-дилей и реверб полосы 0 в режиме perBand - на частоте / getMultirateFactor()
+        // (полуполосные фильтры, см. HalfBandResampler). Под Low полосой (< lowMidCrossover)
+        // почти нет энергии выше новой частоты Найквиста. Задержка ресэмплинга засчитывается
+        // в пре-дилей. Применяется в prepare(), только вместе с perBand (движок тоже фиксируется там).
+        // Полноскоростной работы и памяти у полосы 0 тогда нет: ее линия пре-дилея не выделяется
+        // (линия на пониженной частоте в factor раз короче), а группы реверба собираются из полос
+        // 1..N-1 (при 5 полосах - на одну сеть меньше). Сеть группы стоит одинаково при любом
+        // числе занятых линий, поэтому при 4 полосах CPU реверба падает, только когда реверб
+        // есть у одной полосы 0; иначе к полной сети добавляются ресэмплинг и сеть в factor раз дешевле.
+        void setLowBandMultirate(bool shouldBeMultirate) noexcept { lowBandMultirateRequested = shouldBeMultirate; }
+        bool isLowBandMultirate() const noexcept { return lowBandMultirate; }
+
+        // 8x, 4x или 2x - наибольший, при котором частота не ниже minDecimatedSampleRate
+        static int getMultirateFactor(double sampleRate) noexcept
+        {
+            int factor = HalfBandResampler::maxFactor;
+            while (factor > 1 && sampleRate / factor < minDecimatedSampleRate)
+                factor /= 2;
+            return factor;
+        }
+
+        //==============================================================================
+        // Полосы уже разделены в getBandBuffer(); результат перезаписывает output (L/R).
+        // pool != nullptr - сети реверба идут параллельно в пуле рабочих потоков.
+        void process(juce::AudioBuffer<float>& output, int numSamples, RealtimeThreadPool* pool) noexcept
+        {
+            jassert(output.getNumChannels() >= numChannels && numSamples <= maxBlockSize);
+
+            const bool useSharedSpace = reverbMode == ReverbMode::sharedSpace;
+
+            // 2. Solo и Mute. Заглушенная полоса дозвучивает хвост, после чего засыпает
+            //    (awake == false) и до снятия Mute/Solo не обрабатывается вовсе.
+            std::array<bool, NumBands> awake{};
+            for (size_t b = 0; b < (size_t)NumBands; ++b)
+            {
+                awake[b] = activity[b].beginBlock(silenced[b]);
+                if (silenced[b] && awake[b])
+                    bandBuffers[b].clear(0, numSamples);
+            }
+
+            // 3. Полоса дает в выход сухую часть до пре-дилея и чистый wet после реверба:
+            //    out += M * (1 - wet) * dry + M * wet * reverb, где M - гейн и панорама полосы.
+            std::array<bool, NumBands> reverbed{}; // Полоса проходит через пре-дилей и реверб в этом блоке
+            std::array<float, NumBands> dryPeak{};
+            std::array<float, NumBands> wetLevel{}; // Wet на начало блока (для оценки пика при дозвучивании)
+            std::array<std::array<float* const*, MultiBandReverb::numLanes>, numReverbGroups> reverbLanes{};
+
+            std::array<StereoMatrixMixer::Input, NumBands> dryInputs, wetInputs, bandWet;
+            int numDryInputs = 0, numWetInputs = 0;
+
+            // 3.1 Матрицы полос (гейн x панорама x Wet) и сухая часть всех полос в выход одним проходом.
+            //     Первая полоса пишет, остальные добавляют, поэтому output.clear() не нужен.
+            for (size_t b = 0; b < (size_t)NumBands; ++b)
+            {
+                if (!awake[b])
+                    continue; // Спящая полоса ничего не добавляет в выход
+
+                const auto& wetRamp = wetRamps[b];
+                reverbed[b] = !bypassed[b] && (wetRamp.isRamping() || wetRamp.getCurrentValue() > 0.0f);
+                wetLevel[b] = reverbed[b] ? wetRamp.getCurrentValue() : 0.0f;
+
+                auto& dry = dryInputs[(size_t)numDryInputs++];
+                advanceMix((int)b, numSamples, dry, bandWet[b]);
+                dry.left = bandBuffers[b].getReadPointer(0);
+                dry.right = bandBuffers[b].getReadPointer(1);
+
+                if (activity[b].getState() == BandActivityTracker::State::draining)
+                    dryPeak[b] = bandBuffers[b].getMagnitude(0, numSamples);
+            }
+
+            StereoMatrixMixer::process(dryInputs.data(), numDryInputs,
+                output.getWritePointer(0), output.getWritePointer(1), numSamples, false);
+
+            // Пре-дилей и ранние отражения полос с ревербом (in-place, сухая часть уже в выходе)
+            for (size_t b = 0; b < (size_t)NumBands; ++b)
+            {
+                if (!awake[b])
+                    continue;
+
+                if (!reverbed[b])
+                {
+                    // Реверб не слышен: состояние сбрасывается один раз, дальше полоса его не вызывает
+                    if (!reverbIdle[b])
+                    {
+                        resetBandReverb((int)b);
+                        reverbIdle[b] = true;
+                    }
+                    continue;
+                }
+
+                reverbIdle[b] = false;
+
+                if (b == 0 && lowBandMultirate)
+                {
+                    processLowBandDecimated(numSamples); // Пре-дилей и реверб на пониженной частоте
+                }
+                else
+                {
+                    processPreDelay((int)b, numSamples);
+
+                    // Общее пространство: ранние отражения полосы сразу, хвост - после суммирования (3.5)
+                    if (useSharedSpace)
+                        sharedSpace.processBand((int)b, bandBuffers[b].getArrayOfWritePointers(), numSamples);
+                    else
+                        reverbLanes[(size_t)getGroup((int)b)][(size_t)getLane((int)b)] = bandBuffers[b].getArrayOfWritePointers();
+                }
+
+                auto& wet = wetInputs[(size_t)numWetInputs++];
+                wet = bandWet[b];
+                wet.left = bandBuffers[b].getReadPointer(0);
+                wet.right = bandBuffers[b].getReadPointer(1);
+            }
+
+            // 3.2 Реверберация: один проход на группу полос (полоса = линия SIMD-регистра).
+            //     Группа без полос с ревербом не вызывается. С пулом каждая сеть (группа x канал)
+            //     - отдельное задание.
+            std::array<int, numReverbGroups> activeGroups{};
+            int numActiveGroups = 0;
+            for (int g = 0; g < numActiveReverbGroups; ++g)
+            {
+                const auto& lanes = reverbLanes[(size_t)g];
+                if (std::any_of(lanes.begin(), lanes.end(), [](float* const* lane) { return lane != nullptr; }))
+                    activeGroups[(size_t)numActiveGroups++] = g;
+            }
+
+            if (pool != nullptr && numActiveGroups > 0)
+            {
+                for (int i = 0; i < numActiveGroups; ++i)
+                    reverbs[(size_t)activeGroups[(size_t)i]].beginBlock(reverbLanes[(size_t)activeGroups[(size_t)i]], numSamples);
+
+                auto network = [this, &activeGroups, numSamples](int job)
+                {
+                    const int group = activeGroups[(size_t)(job / MultiBandReverb::numChannels)];
+                    reverbs[(size_t)group].processNetwork(job % MultiBandReverb::numChannels, numSamples);
+                };
+                pool->parallelFor(numActiveGroups * MultiBandReverb::numChannels, network);
+
+                for (int i = 0; i < numActiveGroups; ++i)
+                    reverbs[(size_t)activeGroups[(size_t)i]].endBlock(numSamples);
+            }
+            else
+            {
+                for (int i = 0; i < numActiveGroups; ++i)
+                    reverbs[(size_t)activeGroups[(size_t)i]].process(reverbLanes[(size_t)activeGroups[(size_t)i]], numSamples);
+            }
+
+            // 3.3 Чистый wet всех полос с ревербом - в выход одним проходом
+            StereoMatrixMixer::process(wetInputs.data(), numWetInputs,
+                output.getWritePointer(0), output.getWritePointer(1), numSamples, true);
+
+            // 3.4 Дозвучивание заглушенной полосы: когда хвост затих, полоса засыпает
+            for (size_t b = 0; b < (size_t)NumBands; ++b)
+            {
+                if (!awake[b] || activity[b].getState() != BandActivityTracker::State::draining)
+                    continue;
+
+                // Гейн и Wet применяются при суммировании, поэтому учитываем их в пике
+                const float wet = wetLevel[b];
+                const float wetPeak = reverbed[b] ? bandBuffers[b].getMagnitude(0, numSamples) : 0.0f;
+                const float bandPeak = (dryPeak[b] * (1.0f - wet) + wetPeak * wet) * gainRamps[b].getCurrentValue();
+
+                int pendingDelay = reverbed[b] ? getPendingPreDelaySamples((int)b) : 0;
+                if (reverbed[b] && useSharedSpace)
+                    pendingDelay += sharedSpace.getMaxEarlyDelaySamples();
+
+                if (activity[b].endBlock(bandPeak, numSamples, pendingDelay))
+                    resetBandReverb((int)b);
+            }
+
+            // 3.5 Общий поздний хвост всех полос (дозвучивает и при спящих полосах)
+            if (useSharedSpace)
+                sharedSpace.processLate(output.getArrayOfWritePointers(), numSamples);
+        }
+
+        // Пре-дилей (+ ранние отражения) для детекторов тишины
+        int getMaxPendingDelaySamples() const noexcept
+        {
+            int maxPendingDelay = 0;
+            for (int band = 0; band < NumBands; ++band)
+                maxPendingDelay = std::max(maxPendingDelay, getPendingPreDelaySamples(band));
+
+            // Ранние отражения общего пространства - еще одна задержка после пре-дилея
+            if (reverbMode == ReverbMode::sharedSpace)
+                maxPendingDelay += sharedSpace.getMaxEarlyDelaySamples();
+            return maxPendingDelay;
+        }
+
+        int getMaximumBlockSize() const noexcept { return maxBlockSize; }
+
+        // Время одной сети реверба (группа x канал) на numSamples отсчетов, мкс (лучшее из
+        // нескольких прогонов) - работа одного задания параллельной обработки.
+        // Только вне аудиопотока, после prepare(); состояние реверба сбрасывается.
+        // 0 - сетей по группам нет (sharedSpace).
+        double measureReverbNetworkMicroseconds(int numSamples)
+        {
+            if (numActiveReverbGroups == 0)
+                return 0.0;
+
+            numSamples = juce::jlimit(1, juce::jmax(1, maxBlockSize), numSamples);
+            auto& reverb = reverbs[0];
+            const std::array<float* const*, MultiBandReverb::numLanes> noLanes{}; // Нули на входе
+            double best = std::numeric_limits<double>::max();
+
+            for (int run = 0; run < 5; ++run)
+            {
+                reverb.beginBlock(noLanes, numSamples);
+                const auto start = juce::Time::getHighResolutionTicks();
+                reverb.processNetwork(0, numSamples);
+                const auto end = juce::Time::getHighResolutionTicks();
+                reverb.endBlock(numSamples);
+                best = std::min(best, juce::Time::highResolutionTicksToSeconds(end - start) * 1.0e6);
+            }
+
+            reverb.reset();
+            return best;
+        }
+
+    private:
+        // --- Структура массивов: индекс - номер полосы ---
+        std::array<juce::AudioBuffer<float>, NumBands> bandBuffers;
+        PreDelayLines preDelays; // Линия на полосу + lowBandLine
+        static constexpr int lowBandLine = NumBands;
+        float maxPreDelayMs = defaultMaxPreDelayMs;
+        std::array<ParameterRamp, NumBands> leftPanRamps, rightPanRamps, gainRamps, wetRamps, preDelayRamps;
+        std::array<BandActivityTracker, NumBands> activity;
+        std::array<float, NumBands> wetTargets{};
+        std::array<float, NumBands> preDelayMs{};
+        std::array<float, NumBands> roomSizes = makeFilled(0.5f);
+        std::array<float, NumBands> dampings = makeFilled(0.5f);
+        std::array<bool, NumBands> bypassed{};
+        std::array<bool, NumBands> silenced{};
+        std::array<bool, NumBands> reverbIdle{}; // Wet = 0 или байпас: состояние реверба полосы уже сброшено
+
+        std::array<MultiBandReverb, numReverbGroups> reverbs; // Полоса firstGroupBand - линия 0 группы 0
+        SharedSpaceReverb sharedSpace; // Ранние отражения полос + один общий хвост
+        ReverbMode requestedReverbMode = ReverbMode::perBand;
+        ReverbMode reverbMode = ReverbMode::perBand; // Фиксируется в prepare()
+        int firstGroupBand = 0;        // 1 - полоса 0 на пониженной частоте, вне групп
+        int numActiveReverbGroups = 1; // Подготовленные группы (0 в sharedSpace)
+
+        // --- Полоса 0 на пониженной частоте (см. setLowBandMultirate) ---
+        bool lowBandMultirateRequested = false;
+        bool lowBandMultirate = false; // Фиксируется в prepare()
+        HalfBandResampler lowBandResampler;
+        MultiBandReverb lowBandReverb; // Используется линия 0
+
+        juce::AudioBuffer<float> rampBuffer; // Задержка пре-дилея по отсчетам, пока идет рампа
+        double sampleRate = 44100.0;
+        int maxBlockSize = 0;
+
+        static std::array<float, NumBands> makeFilled(float value) noexcept
+        {
+            std::array<float, NumBands> a;
+            a.fill(value);
+            return a;
+        }
+
+        // Группа и линия полноскоростного реверба полосы (полоса 0 в режиме multirate их не имеет)
+        int getGroup(int band) const noexcept { return (band - firstGroupBand) / MultiBandReverb::numLanes; }
+        int getLane(int band) const noexcept { return (band - firstGroupBand) % MultiBandReverb::numLanes; }
+        MultiBandReverb& getReverb(int band) noexcept { return reverbs[(size_t)getGroup(band)]; }
+
+        // 100% Wet внутри модуля реверба: Wet полосы применяется при сведении.
+        // В sharedSpace сетей по группам нет, параметры полосы идут в посыл (updateSend).
+        void applyReverbParameters(int band) noexcept
+        {
+            if (band == 0 && lowBandMultirate)
+                lowBandReverb.setParameters(0, makeReverbParameters(0));
+            else if (reverbMode == ReverbMode::perBand)
+                getReverb(band).setParameters(getLane(band), makeReverbParameters(band));
+        }
+
+        // Пре-дилей и реверб полосы в выбранном движке - в тишину
+        void resetBandReverb(int band) noexcept
+        {
+            if (band == 0 && lowBandMultirate)
+            {
+                resetLowBand();
+                return;
+            }
+
+            preDelays.resetLine(band);
+            if (reverbMode == ReverbMode::sharedSpace)
+                sharedSpace.resetBand(band);
+            else
+                getReverb(band).resetLane(getLane(band));
+        }
+
+        void resetLowBand() noexcept
+        {
+            lowBandResampler.reset();
+            preDelays.resetLine(lowBandLine);
+            lowBandReverb.reset();
+        }
+
+        // Пре-дилей полосы в отсчетах исходной частоты (у пониженной - вместе с ресэмплингом)
+        int getPendingPreDelaySamples(int band) const noexcept
+        {
+            if (band == 0 && lowBandMultirate)
+                return (int)std::ceil(preDelays.getDelay(lowBandLine) * (float)lowBandResampler.getFactor())
+                     + lowBandResampler.getLatencySamples();
+
+            return (int)std::ceil(preDelays.getDelay(band));
+        }
+
+        MultiBandReverb::Parameters makeReverbParameters(int band) const noexcept
+        {
+            MultiBandReverb::Parameters params;
+            params.roomSize = roomSizes[(size_t)band];
+            params.damping = dampings[(size_t)band];
+            params.wetLevel = 1.0f;
+            params.dryLevel = 0.0f;
+            params.width = 1.0f;
+            params.freezeMode = 0.0f;
+            return params;
+        }
+
+        float getPreDelaySamples(int band) const noexcept
+        {
+            // Округление до целого отсчета: установившаяся задержка идет по пути без интерполяции
+            const float ms = juce::jlimit(0.0f, maxPreDelayMs, preDelayMs[(size_t)band]);
+            return std::round(ms * 0.001f * (float)sampleRate);
+        }
+
+        // Посыл в общее пространство: Wet с учетом громкости полосы
+        void updateSend(int band) noexcept
+        {
+            const auto b = (size_t)band;
+            sharedSpace.setBandParameters(band, roomSizes[b], dampings[b], wetTargets[b] * gainRamps[b].getTargetValue());
+        }
+
+        // Матрица полосы: гейн x закон панорамы, разделенная на сухую (1 - wet) и wet части,
+        // в начале и в конце блока. Рампы продвигаются на блок; внутри блока матрицу
+        // интерполирует StereoMatrixMixer. В байпасе панорама и Wet не применяются (L = R = гейн).
+        void advanceMix(int band, int numSamples, StereoMatrixMixer::Input& dry, StereoMatrixMixer::Input& wet) noexcept
+        {
+            const auto b = (size_t)band;
+            const bool isBypassed = bypassed[b];
+            auto& gainRamp = gainRamps[b];
+            auto& leftPanRamp = leftPanRamps[b];
+            auto& rightPanRamp = rightPanRamps[b];
+            auto& wetRamp = wetRamps[b];
+
+            auto setMatrices = [isBypassed](float gain, float leftPan, float rightPan, float wetValue,
+                                            StereoMatrix& dryMatrix, StereoMatrix& wetMatrix)
+            {
+                const float left = isBypassed ? gain : gain * leftPan;
+                const float right = isBypassed ? gain : gain * rightPan;
+                const float w = isBypassed ? 0.0f : wetValue;
+                dryMatrix = StereoMatrix::diagonal(left * (1.0f - w), right * (1.0f - w));
+                wetMatrix = StereoMatrix::diagonal(left * w, right * w);
+            };
+
+            setMatrices(gainRamp.getCurrentValue(), leftPanRamp.getCurrentValue(), rightPanRamp.getCurrentValue(),
+                        wetRamp.getCurrentValue(), dry.start, wet.start);
+
+            const float gainEnd = gainRamp.advance(numSamples);
+            const float leftPanEnd = isBypassed ? leftPanRamp.getCurrentValue() : leftPanRamp.advance(numSamples);
+            const float rightPanEnd = isBypassed ? rightPanRamp.getCurrentValue() : rightPanRamp.advance(numSamples);
+            const float wetEnd = isBypassed ? wetRamp.getCurrentValue() : wetRamp.advance(numSamples);
+            setMatrices(gainEnd, leftPanEnd, rightPanEnd, wetEnd, dry.end, wet.end);
+        }
+
+        // Пре-дилей полосы: блоком при постоянной задержке, по отсчетам - пока идет рампа
+        void processPreDelay(int band, int numSamples) noexcept
+        {
+            auto& ramp = preDelayRamps[(size_t)band];
+            auto* const* channels = bandBuffers[(size_t)band].getArrayOfWritePointers();
+
+            if (!ramp.isRamping())
+            {
+                preDelays.process(band, channels, numSamples, ramp.getCurrentValue());
+                return;
+            }
+
+            // Задержка меняется плавно по отсчетам (без щелчков при движении Pre-Delay)
+            auto* delays = rampBuffer.getWritePointer(0);
+            ramp.render(delays, numSamples);
+            preDelays.process(band, channels, numSamples, delays);
+        }
+
+        // Полоса 0 на пониженной частоте: понижение, пре-дилей, реверб (100% wet), повышение.
+        // Пре-дилей сокращается на задержку ресэмплинга; рампа - линейно по отсчетам блока.
+        void processLowBandDecimated(int numSamples) noexcept
+        {
+            auto& buffer = bandBuffers[0];
+            auto& ramp = preDelayRamps[0];
+            const float factor = (float)lowBandResampler.getFactor();
+            const float latency = (float)lowBandResampler.getLatencySamples();
+            auto toLowRate = [factor, latency](float delay) { return juce::jmax(0.0f, delay - latency) / factor; };
+
+            const float startDelay = toLowRate(ramp.getCurrentValue());
+            const float endDelay = ramp.isRamping() ? toLowRate(ramp.advance(numSamples)) : startDelay;
+
+            const int numLowSamples = lowBandResampler.decimate(buffer.getArrayOfReadPointers(), numSamples);
+            float* const* low = lowBandResampler.getDecimatedChannels();
+
+            if (startDelay == endDelay)
+            {
+                preDelays.process(lowBandLine, low, numLowSamples, endDelay);
+            }
+            else
+            {
+                const float step = numLowSamples > 0 ? (endDelay - startDelay) / (float)numLowSamples : 0.0f;
+                auto* delays = rampBuffer.getWritePointer(0);
+                for (int i = 0; i < numLowSamples; ++i)
+                    delays[i] = startDelay + step * (float)(i + 1);
+                preDelays.process(lowBandLine, low, numLowSamples, delays);
+            }
+
+            lowBandReverb.process({ low, nullptr, nullptr, nullptr }, numLowSamples);
+            lowBandResampler.interpolate(buffer.getArrayOfWritePointers(), numSamples);
+        }
+
+        JUCE_DECLARE_NON_COPYABLE(BandProcessor)
+    };
+}
@@ -0,0 +1,375 @@
+#include "BiquadCrossover.h"
+
+#if JUCE_UNIT_TESTS
+#include <algorithm>
+#include <vector>
+#include "CrossoverEngine.h"
+#endif
+
+namespace MBRP_DSP
+{
+    namespace
+    {
+        // Добротности секций Баттерворта 4-го порядка: 1 / (2 cos(pi / 8)), 1 / (2 cos(3 pi / 8))
+        constexpr float butterworth4Q[] = { 0.54119610f, 1.30656296f };
+
+        // Билинейное преобразование с предыскажением, K = tan(pi f / fs)
+        BiquadCoeffs makeLowpass(double K, double Q)
+        {
+            const double norm = 1.0 / (1.0 + K / Q + K * K);
+            const double b0 = K * K * norm;
+            return { (float)b0, (float)(2.0 * b0), (float)b0,
+                     (float)(2.0 * (K * K - 1.0) * norm), (float)((1.0 - K / Q + K * K) * norm) };
+        }
+
+        BiquadCoeffs makeHighpass(double K, double Q, double polarity)
+        {
+            const double norm = 1.0 / (1.0 + K / Q + K * K);
+            return { (float)(polarity * norm), (float)(-2.0 * polarity * norm), (float)(polarity * norm),
+                     (float)(2.0 * (K * K - 1.0) * norm), (float)((1.0 - K / Q + K * K) * norm) };
+        }
+
+        BiquadCoeffs makeAllpass(double K, double Q)
+        {
+            const auto lp = makeLowpass(K, Q);
+            return { lp.a2, lp.a1, 1.0f, lp.a1, lp.a2 };
+        }
+
+        // (1 - s) / (1 + s): AP первого порядка для LR2
+        BiquadCoeffs makeFirstOrderAllpass(double K)
+        {
+            const float c = (float)((K - 1.0) / (K + 1.0));
+            return { c, 1.0f, 0.0f, c, 0.0f };
+        }
+    }
+
+    int BiquadCrossover::getNumSections(CrossoverSlope slope) noexcept
+    {
+        switch (slope)
+        {
+            case CrossoverSlope::lr2: return 1;
+            case CrossoverSlope::lr8: return 4;
+            case CrossoverSlope::lr4:
+            default:                  return 2;
+        }
+    }
+
+    int BiquadCrossover::getNumAllPassSections(CrossoverSlope slope) noexcept
+    {
+        return slope == CrossoverSlope::lr8 ? 2 : 1;
+    }
+
+    void BiquadCrossover::prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        jassert(spec.sampleRate > 0.0);
+        jassert(spec.numChannels <= static_cast<juce::uint32>(numChannels));
+
+        sampleRate = spec.sampleRate;
+        updateCoefficients();
+        reset();
+    }
+
+    void BiquadCrossover::reset()
+    {
+        for (auto& chain : states)
+            for (auto& s : chain)
+                s = {};
+
+        coeffs = targetCoeffs;
+    }
+
+    void BiquadCrossover::setSlope(CrossoverSlope newSlope)
+    {
+        if (slope == newSlope)
+            return;
+
+        slope = newSlope;
+        updateCoefficients();
+        reset();
+    }
+
+    void BiquadCrossover::setCrossoverFrequencies(float lowMidHz, float midHz, float midHighHz)
+    {
+        if (cutoffs[0] == lowMidHz && cutoffs[1] == midHz && cutoffs[2] == midHighHz)
+            return;
+
+        cutoffs = { lowMidHz, midHz, midHighHz };
+        updateCoefficients();
+    }
+
+    void BiquadCrossover::updateCoefficients()
+    {
+        const int numSections = getNumSections(slope);
+
+        for (int i = 0; i < numSplits; ++i)
+        {
+            const double cutoff = juce::jlimit(10.0, 0.49 * sampleRate, (double)cutoffs[(size_t)i]);
+            const double K = std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate);
+            auto& c = targetCoeffs[(size_t)i];
+
+            for (int s = 0; s < numSections; ++s)
+            {
+                const double Q = slope == CrossoverSlope::lr2 ? 0.5
+                               : slope == CrossoverSlope::lr4 ? juce::MathConstants<double>::sqrt2 * 0.5
+                               : (double)butterworth4Q[s % 2];
+                c.lowpass[(size_t)s] = makeLowpass(K, Q);
+                c.highpass[(size_t)s] = makeHighpass(K, Q, slope == CrossoverSlope::lr2 ? -1.0 : 1.0);
+            }
+
+            if (slope == CrossoverSlope::lr2)
+            {
+                c.allpass[0] = makeFirstOrderAllpass(K);
+            }
+            else if (slope == CrossoverSlope::lr4)
+            {
+                c.allpass[0] = makeAllpass(K, juce::MathConstants<double>::sqrt2 * 0.5);
+            }
+            else
+            {
+                c.allpass[0] = makeAllpass(K, butterworth4Q[0]);
+                c.allpass[1] = makeAllpass(K, butterworth4Q[1]);
+            }
+        }
+    }
+
+    bool BiquadCrossover::isGliding() const noexcept
+    {
+        for (int i = 0; i < numSplits; ++i)
+            if (coeffs[(size_t)i].lowpass[0].a1 != targetCoeffs[(size_t)i].lowpass[0].a1)
+                return true;
+
+        return false;
+    }
+
+    BiquadCrossover::LaneSection BiquadCrossover::getLaneSection(const std::array<SplitCoeffs, numSplits>& source,
+                                                                 int chain, int section) noexcept
+    {
+        // Линии 0-1 и 2-3: какие коэффициенты у каждой пары
+        const BiquadCoeffs* pair[2];
+        switch (chain)
+        {
+            case rootChain:
+                pair[0] = &source[1].lowpass[(size_t)section];
+                pair[1] = &source[1].highpass[(size_t)section];
+                break;
+            case compensationChain:
+                pair[0] = &source[2].allpass[(size_t)section];
+                pair[1] = &source[0].allpass[(size_t)section];
+                break;
+            case branchLowChain:
+                pair[0] = &source[0].lowpass[(size_t)section];
+                pair[1] = &source[2].lowpass[(size_t)section];
+                break;
+            case branchHighChain:
+            default:
+                pair[0] = &source[0].highpass[(size_t)section];
+                pair[1] = &source[2].highpass[(size_t)section];
+                break;
+        }
+
+        alignas(16) float b0[4], b1[4], b2[4], a1[4], a2[4];
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            const auto& c = *pair[lane / 2];
+            b0[lane] = c.b0; b1[lane] = c.b1; b2[lane] = c.b2; a1[lane] = c.a1; a2[lane] = c.a2;
+        }
+        return { Vec::fromRawArray(b0), Vec::fromRawArray(b1), Vec::fromRawArray(b2),
+                 Vec::fromRawArray(a1), Vec::fromRawArray(a2) };
+    }
+
+    void BiquadCrossover::processStereo(const float* const* input, const std::array<float* const*, numBands>& bands,
+                                        int numSamples) noexcept
+    {
+        static_assert(Vec::SIMDNumElements == 4, "Раскладка линий рассчитана на 4 x float");
+        if (numSamples <= 0)
+            return;
+
+        const bool gliding = isGliding();
+        switch (slope)
+        {
+            case CrossoverSlope::lr2:
+                gliding ? process<1, 1, true>(input, bands, numSamples) : process<1, 1, false>(input, bands, numSamples);
+                break;
+            case CrossoverSlope::lr8:
+                gliding ? process<4, 2, true>(input, bands, numSamples) : process<4, 2, false>(input, bands, numSamples);
+                break;
+            case CrossoverSlope::lr4:
+            default:
+                gliding ? process<2, 1, true>(input, bands, numSamples) : process<2, 1, false>(input, bands, numSamples);
+                break;
+        }
+
+        coeffs = targetCoeffs;
+    }
+
+    template <int NumSections, int NumAllPassSections, bool Gliding>
+    void BiquadCrossover::process(const float* const* input, const std::array<float* const*, numBands>& bands,
+                                  int numSamples) noexcept
+    {
+        constexpr int sectionsOf[numChains] = { NumSections, NumAllPassSections, NumSections, NumSections };
+
+        // Коэффициенты и состояние - в локальных массивах, чтобы держать их в регистрах
+        LaneSection c[numChains][NumSections], dc[numChains][NumSections];
+        SectionState s[numChains][NumSections];
+        const Vec invN = Vec::expand(1.0f / (float)numSamples);
+
+        for (int chain = 0; chain < numChains; ++chain)
+        {
+            for (int k = 0; k < sectionsOf[chain]; ++k)
+            {
+                c[chain][k] = getLaneSection(coeffs, chain, k);
+                s[chain][k] = states[(size_t)chain][(size_t)k];
+
+                if constexpr (Gliding)
+                {
+                    const auto t = getLaneSection(targetCoeffs, chain, k);
+                    dc[chain][k] = { (t.b0 - c[chain][k].b0) * invN, (t.b1 - c[chain][k].b1) * invN,
+                                     (t.b2 - c[chain][k].b2) * invN, (t.a1 - c[chain][k].a1) * invN,
+                                     (t.a2 - c[chain][k].a2) * invN };
+                }
+            }
+        }
+
+        auto runChain = [&](int chain, Vec x)
+        {
+            for (int k = 0; k < sectionsOf[chain]; ++k)
+            {
+                auto& q = c[chain][k];
+                auto& st = s[chain][k];
+                if constexpr (Gliding)
+                {
+                    const auto& d = dc[chain][k];
+                    q.b0 += d.b0; q.b1 += d.b1; q.b2 += d.b2; q.a1 += d.a1; q.a2 += d.a2;
+                }
+
+                const Vec y = q.b0 * x + st.s1;
+                st.s1 = q.b1 * x - q.a1 * y + st.s2;
+                st.s2 = q.b2 * x - q.a2 * y;
+                x = y;
+            }
+            return x;
+        };
+
+        alignas(16) float x[4], low[4], high[4];
+        for (int i = 0; i < numSamples; ++i)
+        {
+            x[0] = x[2] = input[0][i];
+            x[1] = x[3] = input[1][i];
+
+            // { L, R, L, R } -> { нижняя ветка L/R, верхняя ветка L/R } с компенсацией
+            const Vec halves = runChain(compensationChain, runChain(rootChain, Vec::fromRawArray(x)));
+            runChain(branchLowChain, halves).copyToRawArray(low);
+            runChain(branchHighChain, halves).copyToRawArray(high);
+
+            bands[0][0][i] = low[0];
+            bands[0][1][i] = low[1];
+            bands[1][0][i] = high[0];
+            bands[1][1][i] = high[1];
+            bands[2][0][i] = low[2];
+            bands[2][1][i] = low[3];
+            bands[3][0][i] = high[2];
+            bands[3][1][i] = high[3];
+        }
+
+        // Аналог util::snapToZero из JUCE для всех линий регистра
+        auto snapToZero = [](Vec& v)
+        {
+            alignas(16) float tmp[4];
+            v.copyToRawArray(tmp);
+            for (auto& value : tmp)
+                if (!(value < -1.0e-8f || value > 1.0e-8f))
+                    value = 0.0f;
+            v = Vec::fromRawArray(tmp);
+        };
+
+        for (int chain = 0; chain < numChains; ++chain)
+        {
+            for (int k = 0; k < sectionsOf[chain]; ++k)
+            {
+                snapToZero(s[chain][k].s1);
+                snapToZero(s[chain][k].s2);
+                states[(size_t)chain][(size_t)k] = s[chain][k];
+            }
+        }
+    }
+
+#if JUCE_UNIT_TESTS
+    //==============================================================================
+    // Замер стоимости крутизны: LR2/LR4/LR8 на стерео-блоке 512 отсчетов (48 кГц, шум),
+    // рядом - каскад CrossoverEngine на тех же данных. Медиана по numRuns прогонам,
+    // время на блок пишется в лог.
+    class BiquadCrossoverTests : public juce::UnitTest
+    {
+    public:
+        BiquadCrossoverTests() : juce::UnitTest("BiquadCrossover", "MBRP") {}
+
+        void runTest() override
+        {
+            beginTest("Cost per slope (benchmark)");
+
+            constexpr int numBands = BiquadCrossover::numBands;
+            constexpr int blockSize = 512;
+            constexpr int numBlocks = 2000;
+            constexpr int numRuns = 7;
+            const juce::dsp::ProcessSpec spec{ 48000.0, (juce::uint32)blockSize, 2 };
+
+            juce::AudioBuffer<float> input(2, blockSize);
+            juce::Random random(0xb1ad);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    input.getWritePointer(ch)[i] = random.nextFloat() * 2.0f - 1.0f;
+
+            juce::AudioBuffer<float> output(2 * numBands, blockSize);
+            std::array<std::array<float*, 2>, numBands> channels;
+            std::array<float* const*, numBands> bands;
+            for (int b = 0; b < numBands; ++b)
+            {
+                channels[(size_t)b] = { output.getWritePointer(2 * b), output.getWritePointer(2 * b + 1) };
+                bands[(size_t)b] = channels[(size_t)b].data();
+            }
+
+            // Медиана времени numRuns прогонов по numBlocks блоков, мкс на блок
+            auto measure = [&](auto&& processBlock)
+            {
+                std::vector<double> runs;
+                for (int run = 0; run < numRuns; ++run)
+                {
+                    const auto start = juce::Time::getHighResolutionTicks();
+                    for (int block = 0; block < numBlocks; ++block)
+                        processBlock();
+                    runs.push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e6 / numBlocks);
+                }
+                std::sort(runs.begin(), runs.end());
+                return runs[(size_t)numRuns / 2];
+            };
+
+            CrossoverEngine cascade;
+            cascade.setCrossoverFrequencies(200.0f, 1000.0f, 5000.0f);
+            cascade.prepare(spec);
+            const double cascadeMicroseconds = measure([&]
+            {
+                cascade.processStereo(input.getArrayOfReadPointers(), channels[0].data(), channels[1].data(),
+                                      channels[2].data(), channels[3].data(), blockSize);
+            });
+            logMessage("CrossoverEngine cascade: " + juce::String(cascadeMicroseconds, 2) + " us per block");
+
+            const char* const slopeNames[] = { "LR2", "LR4", "LR8" };
+            for (int s = 0; s < 3; ++s)
+            {
+                BiquadCrossover crossover;
+                crossover.setSlope(static_cast<CrossoverSlope>(s));
+                crossover.setCrossoverFrequencies(200.0f, 1000.0f, 5000.0f);
+                crossover.prepare(spec);
+
+                const double microseconds = measure([&] { crossover.processStereo(input.getArrayOfReadPointers(), bands, blockSize); });
+                logMessage("BiquadCrossover " + juce::String(slopeNames[s]) + ": " + juce::String(microseconds, 2)
+                           + " us per block (" + juce::String(microseconds / cascadeMicroseconds, 2) + " x cascade)");
+
+                expect(output.getMagnitude(0, blockSize) < 10.0f, "Output is not bounded");
+            }
+        }
+    };
+
+    static BiquadCrossoverTests biquadCrossoverTests;
+#endif
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+namespace MBRP_DSP
+{
+    // Крутизна разделения: LR2 (12 дБ/окт), LR4 (24 дБ/окт), LR8 (48 дБ/окт)
+    enum class CrossoverSlope { lr2 = 0, lr4, lr8 };
+
+    // Коэффициенты биквада (a0 = 1), transposed direct form II
+    struct BiquadCoeffs
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    };
+
+    //==============================================================================
+    // Кроссовер на 4 полосы из каскадов биквадов (TDF-II) с выбираемой крутизной.
+    // LR(2n) = Баттерворт порядка n дважды: LR2 - 1 биквад (Q = 0.5), LR4 - 2 биквада,
+    // LR8 - 4 биквада на фильтр. У LR2 выход HP инвертирован, иначе сумма дает провал на срезе.
+    //
+    // Дерево: корень делит на midCrossover, ветки - на lowMid/midHighCrossover.
+    // LP + HP разделения = всепропускающий фильтр (AP) Баттерворта порядка n на его частоте,
+    // поэтому нижняя ветка проходит AP(midHigh), верхняя - AP(lowMid), и сумма полос -
+    // произведение AP всех частот (плоская АЧХ при любой крутизне).
+    //
+    // Линии SIMD-регистра - { L, R, L, R }: у корня линии 0-1 считают LP, 2-3 - HP;
+    // у веток линии 0-1 - нижняя ветка, 2-3 - верхняя. На стерео-отсчет приходится
+    // 3 векторные цепочки по n биквадов и цепочка AP (LR2: 3 + 1, LR4: 6 + 1, LR8: 12 + 2 биквада).
+    // Стоимость каждой крутизны рядом с каскадом CrossoverEngine замеряет BiquadCrossoverTests
+    // в BiquadCrossover.cpp (при JUCE_UNIT_TESTS), время на стерео-блок пишется в лог.
+    //
+    // Смена частот - как у CrossoverEngine: коэффициенты линейно интерполируются
+    // к цели внутри следующего блока. Смена крутизны сбрасывает состояние фильтров.
+    class BiquadCrossover
+    {
+    public:
+        using Vec = juce::dsp::SIMDRegister<float>;
+
+        static constexpr int numBands = 4;
+        static constexpr int numSplits = numBands - 1;
+        static constexpr int numChannels = 2;
+        static constexpr int maxSections = 4;         // LR8: Баттерворт 4-го порядка дважды
+        static constexpr int maxAllPassSections = 2;  // AP Баттерворта 4-го порядка
+
+        void prepare(const juce::dsp::ProcessSpec& spec);
+
+        // Очищает состояние фильтров и завершает незаконченное скольжение коэффициентов
+        void reset();
+
+        void setSlope(CrossoverSlope newSlope);
+        CrossoverSlope getSlope() const noexcept { return slope; }
+
+        // Частоты уже должны быть упорядочены (см. MIN_CROSSOVER_SEPARATION в процессоре)
+        void setCrossoverFrequencies(float lowMidHz, float midHz, float midHighHz);
+
+        // input - L/R, bands[b] - L/R буферы полосы b (не должны совпадать со входом)
+        void processStereo(const float* const* input, const std::array<float* const*, numBands>& bands,
+                           int numSamples) noexcept;
+
+        static int getNumSections(CrossoverSlope slope) noexcept;        // Биквадов на LP или HP
+        static int getNumAllPassSections(CrossoverSlope slope) noexcept; // Биквадов на AP компенсации
+
+    private:
+        struct SplitCoeffs
+        {
+            std::array<BiquadCoeffs, maxSections> lowpass, highpass;
+            std::array<BiquadCoeffs, maxAllPassSections> allpass;
+        };
+
+        // Цепочки векторных биквадов: корень, AP веток, LP и HP веток
+        enum Chain { rootChain = 0, compensationChain, branchLowChain, branchHighChain, numChains };
+
+        struct LaneSection { Vec b0, b1, b2, a1, a2; };
+        struct SectionState { Vec s1, s2; };
+
+        double sampleRate = 44100.0;
+        CrossoverSlope slope = CrossoverSlope::lr4;
+        std::array<float, numSplits> cutoffs{ 200.0f, 1000.0f, 5000.0f };
+        std::array<SplitCoeffs, numSplits> coeffs;       // на начало блока
+        std::array<SplitCoeffs, numSplits> targetCoeffs; // на конец блока
+        std::array<std::array<SectionState, maxSections>, numChains> states;
+
+        void updateCoefficients();
+        bool isGliding() const noexcept;
+
+        static LaneSection getLaneSection(const std::array<SplitCoeffs, numSplits>& source, int chain, int section) noexcept;
+
+        template <int NumSections, int NumAllPassSections, bool Gliding>
+        void process(const float* const* input, const std::array<float* const*, numBands>& bands, int numSamples) noexcept;
+    };
+}
@@ -0,0 +1,130 @@
+#include "CaptureRing.h"
+#include <algorithm>
+
+namespace MBRP_DSP
+{
+    void CaptureRing::prepare(double sampleRate, int maxBlockSize)
+    {
+        if (!allocated.load())
+        {
+            for (auto& channel : channels)
+                channel.assign((size_t)capacity, 0.0f);
+            allocated.store(true, std::memory_order_release);
+        }
+
+        // Блок длиннее четверти кольца пишется частями (см. push)
+        maxBlock.store(juce::jlimit(1, capacity / 4, maxBlockSize));
+        consumerTimeoutSamples = (int)(consumerTimeoutSeconds * sampleRate);
+        samplesWithoutConsumer = consumerTimeoutSamples + 1; // До первого pull() запись не идет
+        capturing = false;
+    }
+
+    void CaptureRing::writeChannel(int channel, const float* source, juce::uint64 position, int numSamples) noexcept
+    {
+        auto* ring = channels[(size_t)channel].data();
+        const int start = (int)(position & (juce::uint64)mask);
+        const int first = std::min(numSamples, capacity - start);
+        std::copy(source, source + first, ring + start);
+        std::copy(source + first, source + numSamples, ring);
+    }
+
+    void CaptureRing::readChannel(int channel, float* dest, juce::uint64 position, int numSamples) const noexcept
+    {
+        const auto* ring = channels[(size_t)channel].data();
+        const int start = (int)(position & (juce::uint64)mask);
+        const int first = std::min(numSamples, capacity - start);
+        std::copy(ring + start, ring + start + first, dest);
+        std::copy(ring, ring + (numSamples - first), dest + first);
+    }
+
+    bool CaptureRing::beginBlock(int numSamples) noexcept
+    {
+        if (!allocated.load(std::memory_order_relaxed))
+            return false;
+
+        if (consumerSeen.exchange(false, std::memory_order_relaxed))
+            samplesWithoutConsumer = 0;
+        else
+            samplesWithoutConsumer = std::min(samplesWithoutConsumer + numSamples, consumerTimeoutSamples + 1);
+
+        capturing = enabled.load(std::memory_order_relaxed)
+                 && samplesWithoutConsumer <= consumerTimeoutSamples;
+        return capturing;
+    }
+
+    void CaptureRing::write(const float* left, const float* right, int numSamples) noexcept
+    {
+        if (numSamples <= 0)
+            return;
+
+        const auto position = writePosition.load(std::memory_order_relaxed);
+
+        // Из слишком длинного блока в кольцо идет только хвост, позиция сдвигается на весь блок
+        const int chunk = std::min(numSamples, maxBlock.load(std::memory_order_relaxed));
+        const int skip = numSamples - chunk;
+        writeChannel(0, left + skip, position + (juce::uint64)skip, chunk);
+        writeChannel(1, right + skip, position + (juce::uint64)skip, chunk);
+
+        writePosition.store(position + (juce::uint64)numSamples, std::memory_order_release);
+    }
+
+    void CaptureRing::push(const juce::AudioBuffer<float>& buffer, int numChannelsToCapture) noexcept
+    {
+        const int numSamples = buffer.getNumSamples();
+        if (!beginBlock(numSamples) || numChannelsToCapture <= 0)
+        {
+            capturing = false;
+            return;
+        }
+
+        write(buffer.getReadPointer(0), buffer.getReadPointer(numChannelsToCapture > 1 ? 1 : 0), numSamples);
+    }
+
+    int CaptureRing::pull(float* left, float* right, int maxSamples) noexcept
+    {
+        consumerSeen.store(true, std::memory_order_relaxed);
+        if (!allocated.load(std::memory_order_acquire) || maxSamples <= 0)
+            return 0;
+
+        // Писатель может перезаписать до guard отсчетов сверх опубликованной позиции,
+        // пока идет копирование: читаем не дальше capacity - 2 * guard от нее
+        const auto guard = (juce::uint64)maxBlock.load(std::memory_order_relaxed);
+        const auto window = (juce::uint64)capacity - 2 * guard;
+
+        const auto position = writePosition.load(std::memory_order_acquire);
+        if (position - readPosition > window)
+        {
+            lostSamples += position - window - readPosition;
+            readPosition = position - window;
+        }
+
+        int numSamples = (int)std::min((juce::uint64)maxSamples, position - readPosition);
+        if (numSamples <= 0)
+            return 0;
+
+        readChannel(0, left, readPosition, numSamples);
+        readChannel(1, right, readPosition, numSamples);
+
+        // Проверка после копирования: все, что старше newPosition + guard - capacity,
+        // могло быть перезаписано на ходу и отбрасывается
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto newPosition = writePosition.load(std::memory_order_relaxed);
+        const auto safeStart = newPosition + guard > (juce::uint64)capacity ? newPosition + guard - (juce::uint64)capacity : 0;
+
+        if (readPosition < safeStart)
+        {
+            const auto torn = safeStart - readPosition;
+            lostSamples += torn;
+            readPosition = safeStart;
+            if (torn >= (juce::uint64)numSamples)
+                return 0;
+
+            numSamples -= (int)torn;
+            std::copy(left + torn, left + torn + numSamples, left);
+            std::copy(right + torn, right + torn + numSamples, right);
+        }
+
+        readPosition += (juce::uint64)numSamples;
+        return numSamples;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Стерео-кольцо для анализатора: один писатель (аудиопоток), один читатель.
+    // Без блокировок; писатель никогда не ждет и не теряет блок целиком - когда
+    // читатель отстает, перезаписываются самые старые отсчеты, а читатель
+    // перескакивает к свежим данным (getNumLostSamples()).
+    //
+    // Память выделяется один раз, в первом prepare(); повторные prepare() ее не трогают,
+    // поэтому читатель может работать во время prepareToPlay.
+    //
+    // Читатель подает признак жизни каждым pull(). Если его нет дольше
+    // consumerTimeoutSeconds, push() возвращается сразу: закрытый редактор
+    // аудиопотоку ничего не стоит. Следующий pull() снова включает запись.
+    class CaptureRing
+    {
+    public:
+        static constexpr int numChannels = 2;
+        static constexpr int capacity = 1 << 15;         // Отсчетов на канал, степень двойки
+        static constexpr double consumerTimeoutSeconds = 0.25;
+
+        // Аудиопоток не пишет, пока не выделена память и не пришел первый pull()
+        void prepare(double sampleRate, int maxBlockSize);
+
+        // Запись разрешена (кнопка анализатора); без читателя она все равно не идет
+        void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled); }
+        bool isEnabled() const noexcept { return enabled.load(); }
+
+        // --- Аудиопоток ---
+        // Моно дублируется в оба канала, каналы после второго не пишутся
+        void push(const juce::AudioBuffer<float>& buffer, int numChannelsToCapture) noexcept;
+        bool isCapturing() const noexcept { return capturing; }
+
+        // push() по частям, для писателя с предобработкой (DecimatingCapture): beginBlock()
+        // учитывает numSamples отсчетов в признаке жизни читателя и возвращает isCapturing();
+        // только тогда блок готовится и пишется через write()
+        bool beginBlock(int numSamples) noexcept;
+        void write(const float* left, const float* right, int numSamples) noexcept;
+
+        // --- Поток читателя ---
+        // Копирует до maxSamples отсчетов по порядку; возвращает число скопированных
+        int pull(float* left, float* right, int maxSamples) noexcept;
+        juce::uint64 getNumLostSamples() const noexcept { return lostSamples; }
+
+    private:
+        static constexpr int mask = capacity - 1;
+
+        std::array<std::vector<float>, numChannels> channels;
+        std::atomic<bool> allocated{ false };
+        std::atomic<bool> enabled{ false };
+
+        // Позиции - число отсчетов с начала записи, не индекс в кольце
+        std::atomic<juce::uint64> writePosition{ 0 };
+        std::atomic<int> maxBlock{ 0 }; // Запас, который писатель может перезаписать, пока читатель копирует
+
+        // Признак жизни читателя: читатель ставит, писатель сбрасывает и считает отсчеты без него
+        std::atomic<bool> consumerSeen{ false };
+        int samplesWithoutConsumer = 0;
+        int consumerTimeoutSamples = 0;
+        bool capturing = false;
+
+        juce::uint64 readPosition = 0; // Только читатель
+        juce::uint64 lostSamples = 0;
+
+        void writeChannel(int channel, const float* source, juce::uint64 position, int numSamples) noexcept;
+        void readChannel(int channel, float* dest, juce::uint64 position, int numSamples) const noexcept;
+    };
+}
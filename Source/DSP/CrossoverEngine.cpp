@@ -0,0 +1,321 @@
+#include "CrossoverEngine.h"
+
+namespace MBRP_DSP
+{
+    void CrossoverEngine::prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        jassert(spec.sampleRate > 0.0);
+        jassert(spec.numChannels <= static_cast<juce::uint32>(maxChannels));
+
+        sampleRate = spec.sampleRate;
+        updateCoefficients();
+        reset();
+
+        laneBufferSamples = juce::jmax(1, (int)spec.maximumBlockSize);
+        laneBuffer.setSize(2, 4 * laneBufferSamples);
+    }
+
+    void CrossoverEngine::reset()
+    {
+        for (auto& channelStates : states)
+            for (auto& s : channelStates)
+                s.reset();
+
+        coeffs = targetCoeffs;
+    }
+
+    void CrossoverEngine::setCrossoverFrequencies(float lowMidHz, float midHz, float midHighHz)
+    {
+        if (cutoffs[0] == lowMidHz && cutoffs[1] == midHz && cutoffs[2] == midHighHz)
+            return;
+
+        cutoffs = { lowMidHz, midHz, midHighHz };
+        updateCoefficients();
+    }
+
+    void CrossoverEngine::updateCoefficients()
+    {
+        for (int i = 0; i < numSplits; ++i)
+            targetCoeffs[(size_t)i].setCutoff(cutoffs[(size_t)i], sampleRate);
+    }
+
+    bool CrossoverEngine::isGliding() const noexcept
+    {
+        for (int i = 0; i < numSplits; ++i)
+            if (coeffs[(size_t)i].g != targetCoeffs[(size_t)i].g)
+                return true;
+
+        return false;
+    }
+
+    void CrossoverEngine::processChannel(int channel, const float* input,
+                                         float* low, float* lowMid, float* midHigh, float* high,
+                                         int numSamples) noexcept
+    {
+        jassert(channel >= 0 && channel < maxChannels);
+
+        auto& st = states[(size_t)channel];
+
+        // Копируем коэффициенты и состояние в локальные переменные,
+        // чтобы компилятор держал их в регистрах на протяжении всего цикла
+        float g0 = coeffs[0].g, h0 = coeffs[0].h, k0 = coeffs[0].R2 + g0;
+        float g1 = coeffs[1].g, h1 = coeffs[1].h, k1 = coeffs[1].R2 + g1;
+        float g2 = coeffs[2].g, h2 = coeffs[2].h, k2 = coeffs[2].R2 + g2;
+
+        // Шаги интерполяции коэффициентов к цели (нулевые, если частоты не менялись)
+        const float invN = numSamples > 0 ? 1.0f / (float)numSamples : 0.0f;
+        const float dg0 = (targetCoeffs[0].g - g0) * invN, dh0 = (targetCoeffs[0].h - h0) * invN;
+        const float dg1 = (targetCoeffs[1].g - g1) * invN, dh1 = (targetCoeffs[1].h - h1) * invN;
+        const float dg2 = (targetCoeffs[2].g - g2) * invN, dh2 = (targetCoeffs[2].h - h2) * invN;
+
+        float a1 = st[0].s1, a2 = st[0].s2, a3 = st[0].s3, a4 = st[0].s4;
+        float b1 = st[1].s1, b2 = st[1].s2, b3 = st[1].s3, b4 = st[1].s4;
+        float c1 = st[2].s1, c2 = st[2].s2, c3 = st[2].s3, c4 = st[2].s4;
+
+        // Один LR4 LPF (повторяет LinkwitzRileyFilter::processSample)
+        auto lr4 = [](float x, float g, float k, float h, float& s1, float& s2, float& s3, float& s4)
+        {
+            auto yH = (x - k * s1 - s2) * h;
+            auto yB = g * yH + s1;
+            s1 = g * yH + yB;
+            auto yL = g * yB + s2;
+            s2 = g * yB + yL;
+
+            auto yH2 = (yL - k * s3 - s4) * h;
+            auto yB2 = g * yH2 + s3;
+            s3 = g * yH2 + yB2;
+            auto yL2 = g * yB2 + s4;
+            s4 = g * yB2 + yL2;
+            return yL2;
+        };
+
+        auto run = [&](auto gliding)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                if constexpr (decltype(gliding)::value)
+                {
+                    g0 += dg0; k0 += dg0; h0 += dh0;
+                    g1 += dg1; k1 += dg1; h1 += dh1;
+                    g2 += dg2; k2 += dg2; h2 += dh2;
+                }
+
+                const float x = input[i];
+
+                const float lp0 = lr4(x, g0, k0, h0, a1, a2, a3, a4); // LPF(lowMidCrossover)
+                const float lp1 = lr4(x, g1, k1, h1, b1, b2, b3, b4); // LPF(midCrossover)
+                const float lp2 = lr4(x, g2, k2, h2, c1, c2, c3, c4); // LPF(midHighCrossover)
+
+                low[i] = lp0;
+                lowMid[i] = lp1 - lp0;
+                midHigh[i] = lp2 - lp1;
+                high[i] = x - lp2;
+            }
+        };
+
+        if (isGliding())
+            run(std::true_type{});
+        else
+            run(std::false_type{});
+
+        st[0].s1 = a1; st[0].s2 = a2; st[0].s3 = a3; st[0].s4 = a4;
+        st[1].s1 = b1; st[1].s2 = b2; st[1].s3 = b3; st[1].s4 = b4;
+        st[2].s1 = c1; st[2].s2 = c2; st[2].s3 = c3; st[2].s4 = c4;
+
+        for (auto& s : st)
+            s.snapToZero();
+    }
+
+    void CrossoverEngine::processStereo(const float* const* input,
+                                        float* const* low, float* const* lowMid, float* const* midHigh, float* const* high,
+                                        int numSamples) noexcept
+    {
+        using Vec = juce::dsp::SIMDRegister<float>;
+        using NativeOps = juce::dsp::SIMDNativeOps<float>;
+        static_assert(Vec::SIMDNumElements == 4, "Раскладка линий рассчитана на 4 x float");
+
+        if (numSamples <= 0 || laneBufferSamples == 0)
+        {
+            // Без prepare() буфера линий нет - считаем по каналам
+            processChannel(0, input[0], low[0], lowMid[0], midHigh[0], high[0], numSamples);
+            processChannel(1, input[1], low[1], lowMid[1], midHigh[1], high[1], numSamples);
+            finishBlock();
+            return;
+        }
+
+        alignas(16) float tmp[4];
+
+        // Сборка регистров из скаляров - только до и после цикла по отсчетам
+        auto makeVec = [&tmp](float a, float b, float c, float d)
+        {
+            tmp[0] = a; tmp[1] = b; tmp[2] = c; tmp[3] = d;
+            return Vec::fromRawArray(tmp);
+        };
+
+        auto& stL = states[0];
+        auto& stR = states[1];
+
+        const auto& c0 = coeffs[0];
+        const auto& c1 = coeffs[1];
+        const auto& c2 = coeffs[2];
+
+        // Шаги интерполяции коэффициентов к цели (k = R2 + g меняется с тем же шагом, что и g)
+        const float invN = 1.0f / (float)numSamples;
+        const float dg0 = (targetCoeffs[0].g - c0.g) * invN, dh0 = (targetCoeffs[0].h - c0.h) * invN;
+        const float dg1 = (targetCoeffs[1].g - c1.g) * invN, dh1 = (targetCoeffs[1].h - c1.h) * invN;
+        const float dg2 = (targetCoeffs[2].g - c2.g) * invN, dh2 = (targetCoeffs[2].h - c2.h) * invN;
+
+        // Регистр A: { LPF0 L, LPF0 R, LPF1 L, LPF1 R }, оба каскада LR4 подряд
+        Vec gA = makeVec(c0.g, c0.g, c1.g, c1.g);
+        Vec hA = makeVec(c0.h, c0.h, c1.h, c1.h);
+        Vec kA = makeVec(c0.R2 + c0.g, c0.R2 + c0.g, c1.R2 + c1.g, c1.R2 + c1.g);
+        const Vec dgA = makeVec(dg0, dg0, dg1, dg1);
+        const Vec dhA = makeVec(dh0, dh0, dh1, dh1);
+
+        Vec a1 = makeVec(stL[0].s1, stR[0].s1, stL[1].s1, stR[1].s1);
+        Vec a2 = makeVec(stL[0].s2, stR[0].s2, stL[1].s2, stR[1].s2);
+        Vec a3 = makeVec(stL[0].s3, stR[0].s3, stL[1].s3, stR[1].s3);
+        Vec a4 = makeVec(stL[0].s4, stR[0].s4, stL[1].s4, stR[1].s4);
+
+        // Регистр C: { LPF2 L каскад 1, LPF2 L каскад 2, LPF2 R каскад 1, LPF2 R каскад 2 }.
+        // Четные линии - первый каскад (состояние s1/s2), нечетные - второй (s3/s4)
+        Vec gC = Vec::expand(c2.g);
+        Vec hC = Vec::expand(c2.h);
+        Vec kC = Vec::expand(c2.R2 + c2.g);
+        const Vec dgC = Vec::expand(dg2);
+        const Vec dhC = Vec::expand(dh2);
+
+        Vec cs1 = makeVec(stL[2].s1, stL[2].s3, stR[2].s1, stR[2].s3);
+        Vec cs2 = makeVec(stL[2].s2, stL[2].s4, stR[2].s2, stR[2].s4);
+
+        const Vec evenLanes = makeVec(1.0f, 0.0f, 1.0f, 0.0f);
+        const Vec oddLanes = makeVec(0.0f, 1.0f, 0.0f, 1.0f);
+        const Vec laneL = makeVec(1.0f, 0.0f, 0.0f, 0.0f);
+        const Vec laneR = makeVec(0.0f, 0.0f, 1.0f, 0.0f);
+
+        // Один каскад TPT-Баттерворта (половина LinkwitzRileyFilter::processSample)
+        auto svf = [](Vec x, Vec g, Vec k, Vec h, Vec& s1, Vec& s2)
+        {
+            auto yH = (x - k * s1 - s2) * h;
+            auto yB = g * yH + s1;
+            s1 = g * yH + yB;
+            auto yL = g * yB + s2;
+            s2 = g * yB + yL;
+            return yL;
+        };
+
+        // Выход первого каскада C (четные линии) -> вход второго (нечетные линии)
+        auto feedForward = [&oddLanes](Vec y)
+        {
+            return Vec::fromNative(NativeOps::dupeven(y.value)) * oddLanes;
+        };
+
+        const float* inL = input[0];
+        const float* inR = input[1];
+        float* laneA = laneBuffer.getWritePointer(0);
+        float* laneC = laneBuffer.getWritePointer(1);
+        Vec yC = Vec::expand(0.0f);
+
+        auto stepA = [&](Vec l, Vec r, float* out)
+        {
+            const Vec xA = l * evenLanes + r * oddLanes;
+            svf(svf(xA, gA, kA, hA, a1, a2), gA, kA, hA, a3, a4).copyToRawArray(out);
+        };
+
+        // laneA[4i..] = { LPF0 L, LPF0 R, LPF1 L, LPF1 R } отсчета i,
+        // laneC[4i + 1], laneC[4i + 3] = LPF2 L/R отсчета i
+        auto run = [&](auto gliding, int start, int num)
+        {
+            constexpr bool isGliding = decltype(gliding)::value;
+
+            // Пролог: первый каскад C берет первый отсчет, линии второго не меняются
+            {
+                const Vec keep1 = cs1, keep2 = cs2;
+                if constexpr (isGliding)
+                {
+                    gA += dgA; kA += dgA; hA += dhA;
+                    gC += dgC * evenLanes; kC += dgC * evenLanes; hC += dhC * evenLanes;
+                }
+
+                const Vec l = Vec::expand(inL[start]), r = Vec::expand(inR[start]);
+                stepA(l, r, laneA);
+                yC = svf(l * laneL + r * laneR, gC, kC, hC, cs1, cs2);
+                cs1 = cs1 * evenLanes + keep1 * oddLanes;
+                cs2 = cs2 * evenLanes + keep2 * oddLanes;
+            }
+
+            // Шаг i: A - отсчет i; C - первый каскад отсчета i и второй каскад отсчета i - 1
+            for (int i = 1; i < num; ++i)
+            {
+                if constexpr (isGliding)
+                {
+                    gA += dgA; kA += dgA; hA += dhA;
+                    gC += dgC; kC += dgC; hC += dhC;
+                }
+
+                const Vec l = Vec::expand(inL[start + i]), r = Vec::expand(inR[start + i]);
+                stepA(l, r, laneA + 4 * i);
+                yC = svf(l * laneL + r * laneR + feedForward(yC), gC, kC, hC, cs1, cs2);
+                yC.copyToRawArray(laneC + 4 * (i - 1));
+            }
+
+            // Эпилог: второй каскад C досчитывает последний отсчет, линии первого не меняются
+            {
+                const Vec keep1 = cs1, keep2 = cs2;
+                if constexpr (isGliding)
+                {
+                    gC += dgC * oddLanes; kC += dgC * oddLanes; hC += dhC * oddLanes;
+                }
+
+                svf(feedForward(yC), gC, kC, hC, cs1, cs2).copyToRawArray(laneC + 4 * (num - 1));
+                cs1 = cs1 * oddLanes + keep1 * evenLanes;
+                cs2 = cs2 * oddLanes + keep2 * evenLanes;
+            }
+
+            // Раскладка линий по полосам
+            for (int i = 0; i < num; ++i)
+            {
+                const float* lpA = laneA + 4 * i;
+                const float* lpC = laneC + 4 * i;
+                const int n = start + i;
+
+                low[0][n] = lpA[0];
+                low[1][n] = lpA[1];
+                lowMid[0][n] = lpA[2] - lpA[0];
+                lowMid[1][n] = lpA[3] - lpA[1];
+                midHigh[0][n] = lpC[1] - lpA[2];
+                midHigh[1][n] = lpC[3] - lpA[3];
+                high[0][n] = inL[n] - lpC[1];
+                high[1][n] = inR[n] - lpC[3];
+            }
+        };
+
+        const bool gliding = isGliding();
+        for (int start = 0; start < numSamples; start += laneBufferSamples)
+        {
+            const int num = juce::jmin(laneBufferSamples, numSamples - start);
+            if (gliding)
+                run(std::true_type{}, start, num);
+            else
+                run(std::false_type{}, start, num);
+        }
+
+        // Возвращаем состояние в скалярную раскладку
+        auto storeLanes = [&tmp](Vec v, float& lane0, float& lane1, float& lane2, float& lane3)
+        {
+            v.copyToRawArray(tmp);
+            lane0 = tmp[0]; lane1 = tmp[1]; lane2 = tmp[2]; lane3 = tmp[3];
+        };
+        storeLanes(a1, stL[0].s1, stR[0].s1, stL[1].s1, stR[1].s1);
+        storeLanes(a2, stL[0].s2, stR[0].s2, stL[1].s2, stR[1].s2);
+        storeLanes(a3, stL[0].s3, stR[0].s3, stL[1].s3, stR[1].s3);
+        storeLanes(a4, stL[0].s4, stR[0].s4, stL[1].s4, stR[1].s4);
+        storeLanes(cs1, stL[2].s1, stL[2].s3, stR[2].s1, stR[2].s3);
+        storeLanes(cs2, stL[2].s2, stL[2].s4, stR[2].s2, stR[2].s4);
+
+        for (auto& s : stL) s.snapToZero();
+        for (auto& s : stR) s.snapToZero();
+
+        finishBlock();
+    }
+}
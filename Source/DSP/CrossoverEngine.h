@@ -0,0 +1,97 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+namespace MBRP_DSP
+{
+    // LR4 фильтр нижних частот (два каскада TPT-Баттерворта).
+    // Математика полностью повторяет juce::dsp::LinkwitzRileyFilter (Type::lowpass),
+    // поэтому результат совпадает с прежней цепочкой фильтров отсчет в отсчет.
+    struct LR4LowpassCoeffs
+    {
+        float g = 0.0f;
+        float R2 = 0.0f;
+        float h = 0.0f;
+
+        void setCutoff(float cutoffHz, double sampleRate)
+        {
+            g = static_cast<float>(std::tan(juce::MathConstants<double>::pi * cutoffHz / sampleRate));
+            R2 = static_cast<float>(std::sqrt(2.0));
+            h = static_cast<float>(1.0 / (1.0 + R2 * g + g * g));
+        }
+    };
+
+    struct LR4LowpassState
+    {
+        float s1 = 0.0f, s2 = 0.0f, s3 = 0.0f, s4 = 0.0f;
+
+        void reset() { s1 = s2 = s3 = s4 = 0.0f; }
+
+        // Аналог util::snapToZero из JUCE, вызывается в конце блока
+        void snapToZero()
+        {
+            auto snap = [](float& v) { if (!(v < -1.0e-8f || v > 1.0e-8f)) v = 0.0f; };
+            snap(s1); snap(s2); snap(s3); snap(s4);
+        }
+    };
+
+    //==============================================================================
+    // Движок кроссовера: за один проход по входу формирует все 4 полосы
+    // (Low, Low-Mid, Mid-High, High) и пишет их сразу в буферы полос.
+    // Состояние фильтров на время блока держится в локальных переменных (регистрах),
+    // временные буферы и пары copyFrom/subtract больше не нужны.
+    class CrossoverEngine
+    {
+    public:
+        static constexpr int numBands = 4;
+        static constexpr int numSplits = numBands - 1;
+        static constexpr int maxChannels = 2;
+
+        void prepare(const juce::dsp::ProcessSpec& spec);
+
+        // Очищает состояние фильтров и завершает незаконченное скольжение коэффициентов
+        void reset();
+
+        // Частоты уже должны быть упорядочены (см. MIN_CROSSOVER_SEPARATION в процессоре).
+        // Новые коэффициенты - цель на конец следующего блока: внутри блока g/h/k
+        // линейно интерполируются по отсчетам, tan() считается один раз на блок.
+        // Если задавать частоты каждый блок из ParameterRamp, получается плавное
+        // движение среза без "молнии" и без setCutoffFrequency на каждом отсчете.
+        void setCrossoverFrequencies(float lowMidHz, float midHz, float midHighHz);
+
+        // Один канал: in -> low/lowMid/midHigh/high. Выходы не должны совпадать со входом.
+        // После обработки всех каналов блока нужно вызвать finishBlock().
+        void processChannel(int channel, const float* input,
+                            float* low, float* lowMid, float* midHigh, float* high,
+                            int numSamples) noexcept;
+        void finishBlock() noexcept { coeffs = targetCoeffs; }
+
+        // Стерео через juce::dsp::SIMDRegister, все линии заняты:
+        // регистр A = { LPF0 L, LPF0 R, LPF1 L, LPF1 R } проходит оба каскада LR4 подряд,
+        // регистр C = { LPF2 L каскад 1, LPF2 L каскад 2, LPF2 R каскад 1, LPF2 R каскад 2 } -
+        // конвейер: второй каскад берет выход первого с предыдущего отсчета.
+        // На стерео-отсчет приходится три полных векторных каскада вместо четырех полупустых.
+        // Состояние живет в регистрах весь блок, выходы регистров пишутся подряд в laneBuffer
+        // и раскладываются по полосам вторым проходом.
+        // Результат совпадает с двумя вызовами processChannel (с точностью до знака нуля);
+        // finishBlock() не нужен.
+        void processStereo(const float* const* input,
+                           float* const* low, float* const* lowMid, float* const* midHigh, float* const* high,
+                           int numSamples) noexcept;
+
+    private:
+        double sampleRate = 44100.0;
+        std::array<float, numSplits> cutoffs{ 200.0f, 1000.0f, 5000.0f };
+        std::array<LR4LowpassCoeffs, numSplits> coeffs;        // на начало блока
+        std::array<LR4LowpassCoeffs, numSplits> targetCoeffs;  // на конец блока
+        std::array<std::array<LR4LowpassState, numSplits>, maxChannels> states;
+
+        // Выходы регистров A и C по отсчетам (4 линии на отсчет) для processStereo
+        juce::AudioBuffer<float> laneBuffer;
+        int laneBufferSamples = 0;
+
+        void updateCoefficients();
+        bool isGliding() const noexcept;
+    };
+}
@@ -0,0 +1,57 @@
+#include "DecimatingCapture.h"
+
+namespace MBRP_DSP
+{
+    int DecimatingCapture::chooseFactor(double sampleRate, float maxFrequency) noexcept
+    {
+        int result = 1;
+        while (result < HalfBandResampler::maxFactor && 0.4 * sampleRate / (double)(result * 2) >= (double)maxFrequency)
+            result *= 2;
+        return result;
+    }
+
+    void DecimatingCapture::prepare(double sampleRate, int maxBlockSize, int newFactor)
+    {
+        jassert(newFactor == 1 || newFactor == 2 || newFactor == 4 || newFactor == 8);
+        ring.prepare(sampleRate / newFactor, maxBlockSize / newFactor + 1);
+
+        if (newFactor != decimator.getFactor() || maxBlockSize != preparedBlockSize)
+        {
+            decimator.prepare(newFactor, maxBlockSize);
+            preparedBlockSize = maxBlockSize;
+        }
+
+        factor.store(newFactor);
+        needsReset = true;
+    }
+
+    void DecimatingCapture::push(const juce::AudioBuffer<float>& buffer, int numSamples) noexcept
+    {
+        const int currentFactor = decimator.getFactor();
+        jassert(buffer.getNumChannels() >= 2 && numSamples <= preparedBlockSize);
+
+        if (!ring.beginBlock(numSamples / currentFactor))
+        {
+            needsReset = true;
+            return;
+        }
+
+        if (currentFactor == 1)
+        {
+            ring.write(buffer.getReadPointer(0), buffer.getReadPointer(1), numSamples);
+            return;
+        }
+
+        // Фильтры не работали, пока отвод стоял: их история и фаза устарели
+        if (needsReset)
+        {
+            decimator.reset();
+            needsReset = false;
+        }
+
+        const float* input[] = { buffer.getReadPointer(0), buffer.getReadPointer(1) };
+        const int count = decimator.decimate(input, numSamples);
+        const auto* decimated = decimator.getDecimatedChannels();
+        ring.write(decimated[0], decimated[1], count);
+    }
+}
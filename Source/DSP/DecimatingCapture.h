@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "CaptureRing.h"
+#include "HalfBandResampler.h"
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Захват полосы для анализатора с понижением частоты: нижним полосам для спектра
+    // хватает малой доли отсчетов, поэтому перед CaptureRing они прореживаются
+    // в 2, 4 или 8 раз (HalfBandResampler). Полоса уже ограничена кроссовером сверху,
+    // так что множитель выбирается по верхней границе диапазона ее кроссовера.
+    //
+    // Пока отвод не читают (CaptureRing::beginBlock() == false), push() не трогает
+    // ни фильтры, ни кольцо; при возобновлении история фильтров сбрасывается.
+    class DecimatingCapture
+    {
+    public:
+        DecimatingCapture() = default;
+
+        // Наибольший множитель (1..8, степень двойки), при котором maxFrequency еще
+        // в полосе пропускания полуполосного каскада (0.4 пониженной частоты)
+        static int chooseFactor(double sampleRate, float maxFrequency) noexcept;
+
+        // Аллокации: кольцо - при первом вызове, фильтры - при смене множителя или размера блока
+        void prepare(double sampleRate, int maxBlockSize, int newFactor);
+
+        void setEnabled(bool shouldBeEnabled) noexcept { ring.setEnabled(shouldBeEnabled); }
+        bool isEnabled() const noexcept { return ring.isEnabled(); }
+
+        // --- Аудиопоток --- (L/R полосы, numSamples из начала буфера)
+        void push(const juce::AudioBuffer<float>& buffer, int numSamples) noexcept;
+
+        // --- Поток читателя ---
+        CaptureRing& getRing() noexcept { return ring; }
+        int getFactor() const noexcept { return factor.load(std::memory_order_relaxed); }
+
+    private:
+        CaptureRing ring;
+        HalfBandResampler decimator;
+        std::atomic<int> factor{ 1 };
+        int preparedBlockSize = 0;
+        bool needsReset = true;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DecimatingCapture)
+    };
+}
@@ -0,0 +1,167 @@
+#include "HalfBandResampler.h"
+
+namespace MBRP_DSP
+{
+    HalfBandResampler::HalfBandResampler()
+    {
+        // Полуполосный sinc (срез на четверти частоты) с окном Блэкмана.
+        // Четные отсчеты нормируются на сумму 0.5: с центром 0.5 гейн на DC ровно 1.
+        std::array<double, numTaps> h{};
+        for (int n = 0; n < numTaps; ++n)
+        {
+            const double x = 0.5 * (double)(n - center);
+            const double sinc = n == center ? 0.5 : 0.5 * std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+            const double phase = juce::MathConstants<double>::twoPi * (double)n / (double)(numTaps - 1);
+            h[(size_t)n] = sinc * (0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase));
+        }
+
+        // Нечетные отсчеты, кроме центра, - нули; центр остается ровно 0.5
+        double evenSum = 0.0;
+        for (int j = 0; j < numPhaseTaps; ++j)
+            evenSum += h[(size_t)(2 * j)];
+        for (int j = 0; j < numPhaseTaps; ++j)
+            phaseTaps[(size_t)j] = (float)(h[(size_t)(2 * j)] * 0.5 / evenSum);
+    }
+
+    void HalfBandResampler::prepare(int newFactor, int newMaxBlockSize)
+    {
+        jassert(newFactor == 1 || newFactor == 2 || newFactor == 4 || newFactor == 8);
+        factor = newFactor;
+        numStages = factor == 8 ? 3 : factor == 4 ? 2 : factor == 2 ? 1 : 0;
+        maxBlockSize = newMaxBlockSize;
+
+        for (auto& buffers : stageBuffers)
+            for (auto& buffer : buffers)
+                buffer.assign((size_t)(maxBlockSize + maxFactor), 0.0f);
+        for (auto& fifo : outputFifo)
+            fifo.assign((size_t)(maxBlockSize + 2 * maxFactor), 0.0f);
+
+        reset();
+    }
+
+    void HalfBandResampler::reset()
+    {
+        for (auto& stage : decimators)
+            stage = {};
+        for (auto& stage : interpolators)
+            stage = {};
+
+        for (auto& fifo : outputFifo)
+            std::fill(fifo.begin(), fifo.end(), 0.0f);
+        fifoFill = factor - 1;
+        lastDecimatedCount = 0;
+    }
+
+    int HalfBandResampler::getLatencySamples() const noexcept
+    {
+        // По center отсчетов на ступень в обе стороны (в отсчетах частоты ступени).
+        // Предзаполнение FIFO компенсирует фазу децимации и задержки не добавляет.
+        return 2 * center * (factor - 1);
+    }
+
+    int HalfBandResampler::decimate(const float* const* input, int numSamples) noexcept
+    {
+        jassert(numSamples <= maxBlockSize);
+
+        const float* const* source = input;
+        int count = numSamples;
+
+        for (int s = 0; s < numStages; ++s)
+        {
+            auto& stage = decimators[(size_t)s];
+            auto& destination = stageBuffers[(size_t)(s % 2)];
+            int produced = 0;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto& history = stage.history[(size_t)ch];
+                auto* out = destination[(size_t)ch].data();
+                bool odd = stage.odd;
+                produced = 0;
+
+                for (int i = 0; i < count; ++i)
+                {
+                    const float* window = history.push(source[ch][i]);
+                    if (odd)
+                    {
+                        float y = 0.5f * window[center];
+                        for (int j = 0; j < numPhaseTaps; ++j)
+                            y += phaseTaps[(size_t)j] * window[2 * j];
+                        out[produced++] = y;
+                    }
+                    odd = !odd;
+                }
+            }
+
+            stage.odd = (count % 2 != 0) ? !stage.odd : stage.odd;
+            decimatedChannels = { destination[0].data(), destination[1].data() };
+            source = decimatedChannels.data();
+            count = produced;
+        }
+
+        if (numStages == 0)
+        {
+            // Без понижения: копия входа, чтобы обработка на месте не трогала буфер полосы
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::copy(input[ch], input[ch] + numSamples, stageBuffers[0][(size_t)ch].data());
+            decimatedChannels = { stageBuffers[0][0].data(), stageBuffers[0][1].data() };
+        }
+
+        lastDecimatedCount = count;
+        return count;
+    }
+
+    void HalfBandResampler::interpolate(float* const* output, int numSamples) noexcept
+    {
+        // Ступени в обратном порядке; последняя пишет прямо в конец FIFO.
+        // Вход каскада лежит в stageBuffers[(numStages - 1) % 2], ступени пишут в другой буфер.
+        const float* source[numChannels] = { decimatedChannels[0], decimatedChannels[1] };
+        int count = lastDecimatedCount;
+        int bufferIndex = numStages % 2;
+
+        for (int s = numStages - 1; s >= 0; --s)
+        {
+            auto& stage = interpolators[(size_t)s];
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto& history = stage.history[(size_t)ch];
+                float* out = s == 0 ? outputFifo[(size_t)ch].data() + fifoFill
+                                    : stageBuffers[(size_t)bufferIndex][(size_t)ch].data();
+
+                for (int i = 0; i < count; ++i)
+                {
+                    const float* window = history.push(source[ch][i]);
+                    float y = 0.0f;
+                    for (int j = 0; j < numPhaseTaps; ++j)
+                        y += phaseTaps[(size_t)j] * window[j];
+
+                    out[2 * i] = 2.0f * y;
+                    out[2 * i + 1] = window[numPhaseTaps - 1 - center / 2];
+                }
+
+                if (s > 0)
+                    source[ch] = out;
+            }
+
+            count *= 2;
+            bufferIndex = 1 - bufferIndex;
+        }
+
+        if (numStages == 0)
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::copy(source[ch], source[ch] + count, outputFifo[(size_t)ch].data() + fifoFill);
+
+        // Выход - первые numSamples отсчетов FIFO, остаток сдвигается в начало
+        fifoFill += count;
+        jassert(fifoFill >= numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* fifo = outputFifo[(size_t)ch].data();
+            std::copy(fifo, fifo + numSamples, output[ch]);
+            std::copy(fifo + numSamples, fifo + fifoFill, fifo);
+        }
+        fifoFill -= numSamples;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Понижение и повышение частоты дискретизации в 2, 4 или 8 раз каскадом
+    // полуполосных FIR (31 отсчет, окно Блэкмана) в полифазной форме: у полуполосного
+    // фильтра каждый второй коэффициент нулевой, поэтому на выходной отсчет
+    // дециматора приходится 17 умножений, у интерполятора - 16 на пару отсчетов.
+    //
+    // decimate() отдает переменное число отсчетов (фаза децимации сохраняется между
+    // блоками), interpolate() возвращает ровно столько отсчетов, сколько было на входе
+    // decimate(): выход повышения идет через FIFO с предзаполнением factor - 1 отсчетов.
+    // Задержка всей цепочки - getLatencySamples() отсчетов исходной частоты.
+    class HalfBandResampler
+    {
+    public:
+        static constexpr int numChannels = 2;
+        static constexpr int maxFactor = 8;
+        static constexpr int numTaps = 31;
+
+        HalfBandResampler();
+
+        // factor - 1, 2, 4 или 8; maxBlockSize - на исходной частоте
+        void prepare(int factor, int maxBlockSize);
+        void reset();
+
+        // L/R -> пониженная частота; возвращает число отсчетов в getDecimatedChannels()
+        int decimate(const float* const* input, int numSamples) noexcept;
+        float* const* getDecimatedChannels() noexcept { return decimatedChannels.data(); }
+
+        // Отсчеты getDecimatedChannels() (после обработки на месте) -> numSamples отсчетов
+        // исходной частоты. numSamples - тот же, что и в предыдущем decimate().
+        void interpolate(float* const* output, int numSamples) noexcept;
+
+        int getFactor() const noexcept { return factor; }
+        int getLatencySamples() const noexcept;
+
+    private:
+        static constexpr int maxStages = 3;
+        static constexpr int center = numTaps / 2;
+        static constexpr int numPhaseTaps = (numTaps + 1) / 2; // Ненулевые четные отсчеты
+
+        // Кольцо истории с дублированием: окно последних N отсчетов всегда непрерывно
+        template <int N>
+        struct History
+        {
+            std::array<float, 2 * N> samples{};
+            int index = 0;
+
+            const float* push(float x) noexcept
+            {
+                samples[(size_t)index] = samples[(size_t)(index + N)] = x;
+                index = (index + 1) % N;
+                return samples.data() + index; // От старого к новому
+            }
+        };
+
+        struct DecimatorStage
+        {
+            std::array<History<numTaps>, numChannels> history;
+            bool odd = false;
+        };
+
+        struct InterpolatorStage
+        {
+            std::array<History<numPhaseTaps>, numChannels> history;
+        };
+
+        std::array<float, numPhaseTaps> phaseTaps{}; // h[0], h[2], ..., h[30]; h[center] = 0.5
+
+        int factor = 1;
+        int numStages = 0;
+        int lastDecimatedCount = 0;
+        std::array<DecimatorStage, maxStages> decimators;
+        std::array<InterpolatorStage, maxStages> interpolators;
+
+        // Рабочие буферы каскада (ping-pong) и FIFO выхода повышения
+        std::array<std::array<std::vector<float>, numChannels>, 2> stageBuffers;
+        std::array<std::vector<float>, numChannels> outputFifo;
+        std::array<float*, numChannels> decimatedChannels{};
+        int fifoFill = 0;
+        int maxBlockSize = 0;
+    };
+}
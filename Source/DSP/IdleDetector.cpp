@@ -0,0 +1,42 @@
+#include "IdleDetector.h"
+
+namespace MBRP_DSP
+{
+    void IdleDetector::prepare(double sampleRate)
+    {
+        tracker.prepare(sampleRate, silenceThresholdDb);
+    }
+
+    void IdleDetector::reset()
+    {
+        tracker.reset();
+    }
+
+    float IdleDetector::getPeakLevel(const juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept
+    {
+        float peak = 0.0f;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(ch), numSamples);
+            peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+        }
+
+        return peak;
+    }
+
+    bool IdleDetector::beginBlock(const juce::AudioBuffer<float>& input, int numChannels, int numSamples) noexcept
+    {
+        const bool inputSilent = getPeakLevel(input, numChannels, numSamples) < silenceThresholdGain;
+        return tracker.beginBlock(inputSilent);
+    }
+
+    bool IdleDetector::endBlock(const juce::AudioBuffer<float>& output, int numChannels, int numSamples,
+                                int maxPendingDelaySamples) noexcept
+    {
+        if (!isDraining())
+            return false;
+
+        return tracker.endBlock(getPeakLevel(output, numChannels, numSamples), numSamples, maxPendingDelaySamples);
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "BandActivityTracker.h"
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Режим простоя всего плагина.
+    // Пока на входе цифровая тишина, плагин продолжает работать, пока хвосты
+    // реверба и пре-дилея всех полос не опустятся ниже -120 dBFS, после чего
+    // выход просто обнуляется, а DSP-объекты не вызываются до появления сигнала.
+    class IdleDetector
+    {
+    public:
+        static constexpr float silenceThresholdDb = -120.0f;
+
+        void prepare(double sampleRate);
+        void reset();
+
+        // Пиковый уровень по всем каналам (векторизованный FloatVectorOperations::findMinAndMax)
+        static float getPeakLevel(const juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) noexcept;
+
+        // В начале блока по входу. Возвращает false, если блок можно не обрабатывать.
+        bool beginBlock(const juce::AudioBuffer<float>& input, int numChannels, int numSamples) noexcept;
+
+        // После обработки по выходу. Возвращает true, если плагин только что ушел в простой
+        // (вызывающая сторона сбрасывает DSP, чтобы проснуться с чистым состоянием).
+        bool endBlock(const juce::AudioBuffer<float>& output, int numChannels, int numSamples,
+                      int maxPendingDelaySamples) noexcept;
+
+        bool isIdle() const noexcept { return tracker.isSleeping(); }
+        bool isDraining() const noexcept { return tracker.getState() == BandActivityTracker::State::draining; }
+
+    private:
+        BandActivityTracker tracker;
+        float silenceThresholdGain = juce::Decibels::decibelsToGain(silenceThresholdDb, -200.0f);
+    };
+}
@@ -0,0 +1,352 @@
+#include "LinearPhaseCrossover.h"
+
+namespace MBRP_DSP
+{
+    LinearPhaseCrossover::LinearPhaseCrossover()
+    {
+        for (auto& cutoff : requestedCutoffs)
+            cutoff.store(1000.0f);
+    }
+
+    LinearPhaseCrossover::~LinearPhaseCrossover()
+    {
+        release();
+    }
+
+    int LinearPhaseCrossover::getPartitionSize(double sampleRate) noexcept
+    {
+        const int partition = (int)std::ceil(sampleRate * firLengthSeconds / (double)numPartitions);
+        return juce::nextPowerOfTwo(juce::jmax(64, partition));
+    }
+
+    int LinearPhaseCrossover::getLatencySamples(double sampleRate) noexcept
+    {
+        // Кадрирование P + центр FIR (numPartitions * P - 1 отсчетов, нечетная длина)
+        const int partition = getPartitionSize(sampleRate);
+        return partition + numPartitions * partition / 2 - 1;
+    }
+
+    void LinearPhaseCrossover::prepare(const juce::dsp::ProcessSpec& spec, const std::array<float, numSplits>& initialCutoffs)
+    {
+        jassert(spec.numChannels == (juce::uint32)numChannels);
+        release();
+
+        sampleRate = spec.sampleRate;
+        partitionSize = getPartitionSize(sampleRate);
+        latencySamples = getLatencySamples(sampleRate);
+        firCenter = numPartitions * partitionSize / 2 - 1;
+
+        const int fftOrder = juce::roundToInt(std::log2((double)(2 * partitionSize)));
+        fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+        designFft = std::make_unique<juce::dsp::FFT>(fftOrder);
+
+        const auto spectrumSize = (size_t)(2 * (partitionSize + 1));
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            inputFrame[(size_t)ch].assign((size_t)(2 * partitionSize), 0.0f);
+            frequencyDelayLine[(size_t)ch].assign((size_t)numPartitions * spectrumSize, 0.0f);
+            history[(size_t)ch].assign((size_t)(numPartitions * partitionSize), 0.0f);
+            for (auto& fifo : outputFifo[(size_t)ch])
+                fifo.assign((size_t)partitionSize, 0.0f);
+        }
+        accumulator.assign((size_t)(4 * partitionSize), 0.0f); // Полный комплексный спектр 2P
+        fadeBuffer.assign((size_t)partitionSize, 0.0f);
+
+        designFir.assign((size_t)(numPartitions * partitionSize), 0.0f);
+        designLowpass.assign((size_t)(numPartitions * partitionSize), 0.0f);
+        designBuffer.assign((size_t)(4 * partitionSize), 0.0f);
+        for (auto& slot : slots)
+        {
+            slot.spectra.assign((size_t)(numSplits * numPartitions) * spectrumSize, 0.0f);
+            slot.state.store(FilterSlot::free);
+        }
+
+        // Начальные фильтры - синхронно, чтобы первый блок уже был разделен
+        for (int i = 0; i < numSplits; ++i)
+            requestedCutoffs[(size_t)i].store(initialCutoffs[(size_t)i]);
+        designedGeneration = requestedGeneration.load();
+
+        designFilters(initialCutoffs, slots[0]);
+        slots[0].generation = designedGeneration;
+        slots[0].state.store(FilterSlot::inUse);
+        currentSlot = 0;
+        previousSlot = -1;
+        currentGeneration = designedGeneration;
+
+        reset();
+        designThread.startThread(juce::Thread::Priority::background);
+    }
+
+    void LinearPhaseCrossover::release()
+    {
+        designThread.stopThread(1000);
+    }
+
+    void LinearPhaseCrossover::reset()
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            std::fill(inputFrame[(size_t)ch].begin(), inputFrame[(size_t)ch].end(), 0.0f);
+            std::fill(frequencyDelayLine[(size_t)ch].begin(), frequencyDelayLine[(size_t)ch].end(), 0.0f);
+            std::fill(history[(size_t)ch].begin(), history[(size_t)ch].end(), 0.0f);
+            for (auto& fifo : outputFifo[(size_t)ch])
+                std::fill(fifo.begin(), fifo.end(), 0.0f);
+        }
+        fill = 0;
+        delayLineIndex = 0;
+        historyIndex = 0;
+    }
+
+    void LinearPhaseCrossover::setCrossoverFrequencies(const std::array<float, numSplits>& cutoffs) noexcept
+    {
+        bool changed = false;
+        for (int i = 0; i < numSplits; ++i)
+            changed |= requestedCutoffs[(size_t)i].exchange(cutoffs[(size_t)i]) != cutoffs[(size_t)i];
+
+        if (changed)
+            requestedGeneration.fetch_add(1, std::memory_order_release);
+    }
+
+    //==============================================================================
+    void LinearPhaseCrossover::DesignThread::run()
+    {
+        // Опрос вместо notify(): аудиопоток только пишет атомики и не трогает мьютексы
+        while (!threadShouldExit())
+        {
+            owner.designPendingFilters();
+            wait(10);
+        }
+    }
+
+    void LinearPhaseCrossover::designPendingFilters()
+    {
+        const auto generation = requestedGeneration.load(std::memory_order_acquire);
+        if (generation == designedGeneration)
+            return;
+
+        std::array<float, numSplits> cutoffs{};
+        for (int i = 0; i < numSplits; ++i)
+            cutoffs[(size_t)i] = requestedCutoffs[(size_t)i].load();
+
+        // Частоты поменялись во время чтения - следующий опрос возьмет новые
+        if (requestedGeneration.load(std::memory_order_acquire) != generation)
+            return;
+
+        // Свободный слот или готовый, но еще не забранный (он уже устарел)
+        for (auto& slot : slots)
+        {
+            int expected = FilterSlot::free;
+            if (!slot.state.compare_exchange_strong(expected, FilterSlot::writing))
+            {
+                expected = FilterSlot::ready;
+                if (!slot.state.compare_exchange_strong(expected, FilterSlot::writing))
+                    continue;
+            }
+
+            designFilters(cutoffs, slot);
+            slot.generation = generation;
+            slot.state.store(FilterSlot::ready, std::memory_order_release);
+            designedGeneration = generation;
+            return;
+        }
+    }
+
+    void LinearPhaseCrossover::designFilters(const std::array<float, numSplits>& cutoffs, FilterSlot& slot)
+    {
+        // ФНЧ - sinc с окном Блэкмана, numPartitions * P - 1 отсчетов с центром firCenter.
+        // Полоса b = ФНЧ(b) - ФНЧ(b - 1): АЧХ соседних полос дополняют друг друга,
+        // фаза у всех линейная с одной задержкой.
+        const int firLength = numPartitions * partitionSize - 1;
+        const int spectrumSize = 2 * (partitionSize + 1);
+        const double pi = juce::MathConstants<double>::pi;
+
+        std::fill(designLowpass.begin(), designLowpass.end(), 0.0f);
+
+        for (int band = 0; band < numSplits; ++band)
+        {
+            const double cutoff = (double)juce::jlimit(1.0f, 0.49f * (float)sampleRate, cutoffs[(size_t)band]) / sampleRate;
+
+            auto lowpassTap = [&](int n)
+            {
+                const double x = (double)(n - firCenter);
+                const double sinc = n == firCenter ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * x) / (pi * x);
+                const double phase = 2.0 * pi * (double)n / (double)(firLength - 1);
+                return sinc * (0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase));
+            };
+
+            // Единичный гейн ФНЧ на DC: сумма полос на DC ровно 1
+            double dcGain = 0.0;
+            for (int n = 0; n < firLength; ++n)
+                dcGain += lowpassTap(n);
+
+            for (int n = 0; n < firLength; ++n)
+            {
+                const float lowpass = (float)(lowpassTap(n) / dcGain);
+                designFir[(size_t)n] = lowpass - designLowpass[(size_t)n];
+                designLowpass[(size_t)n] = lowpass;
+            }
+
+            // Спектры частей: часть P отсчетов, дополненная нулями до 2P
+            for (int part = 0; part < numPartitions; ++part)
+            {
+                std::fill(designBuffer.begin(), designBuffer.end(), 0.0f);
+                std::copy(designFir.begin() + part * partitionSize, designFir.begin() + (part + 1) * partitionSize, designBuffer.begin());
+                designFft->performRealOnlyForwardTransform(designBuffer.data(), true);
+
+                std::copy(designBuffer.begin(), designBuffer.begin() + spectrumSize,
+                          slot.spectra.begin() + (size_t)((band * numPartitions + part) * spectrumSize));
+            }
+        }
+    }
+
+    //==============================================================================
+    void LinearPhaseCrossover::processStereo(const float* const* input, const std::array<float* const*, numBands>& bands,
+                                             int numSamples) noexcept
+    {
+        // Выход шага читается из outputFifo, пока на его место копится вход следующего
+        for (int pos = 0; pos < numSamples;)
+        {
+            const int count = juce::jmin(numSamples - pos, partitionSize - fill);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                juce::FloatVectorOperations::copy(inputFrame[(size_t)ch].data() + partitionSize + fill, input[ch] + pos, count);
+                for (int band = 0; band < numBands; ++band)
+                    juce::FloatVectorOperations::copy(bands[(size_t)band][ch] + pos, outputFifo[(size_t)ch][(size_t)band].data() + fill, count);
+            }
+
+            fill += count;
+            pos += count;
+
+            if (fill == partitionSize)
+            {
+                processHop();
+                fill = 0;
+            }
+        }
+    }
+
+    void LinearPhaseCrossover::pickUpNewFilters() noexcept
+    {
+        if (previousSlot >= 0)
+            return;
+
+        int newest = -1;
+        for (int i = 0; i < numSlots; ++i)
+        {
+            auto& slot = slots[(size_t)i];
+            if (slot.state.load(std::memory_order_acquire) == FilterSlot::ready
+                && (int)(slot.generation - currentGeneration) > 0
+                && (newest < 0 || (int)(slot.generation - slots[(size_t)newest].generation) > 0))
+                newest = i;
+        }
+
+        if (newest < 0)
+            return;
+
+        // Фоновый поток мог успеть перезаписать слот - тогда заберем его в следующий шаг
+        int expected = FilterSlot::ready;
+        if (!slots[(size_t)newest].state.compare_exchange_strong(expected, FilterSlot::inUse, std::memory_order_acquire))
+            return;
+
+        previousSlot = currentSlot;
+        currentSlot = newest;
+        currentGeneration = slots[(size_t)newest].generation;
+    }
+
+    void LinearPhaseCrossover::processHop() noexcept
+    {
+        pickUpNewFilters();
+
+        const int spectrumSize = 2 * (partitionSize + 1);
+        const int historySize = numPartitions * partitionSize;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* frame = inputFrame[(size_t)ch].data();
+            auto* historyData = history[(size_t)ch].data();
+
+            // Вход шага в историю для полосы High (historySize делится на P)
+            std::copy(frame + partitionSize, frame + 2 * partitionSize, historyData + historyIndex);
+
+            // Спектр кадра [предыдущий шаг, текущий шаг] в частотную линию задержки
+            std::copy(frame, frame + 2 * partitionSize, accumulator.data());
+            fft->performRealOnlyForwardTransform(accumulator.data(), true);
+            std::copy(accumulator.begin(), accumulator.begin() + spectrumSize,
+                      frequencyDelayLine[(size_t)ch].begin() + (size_t)(delayLineIndex * spectrumSize));
+
+            std::copy(frame + partitionSize, frame + 2 * partitionSize, frame);
+
+            auto& outputs = outputFifo[(size_t)ch];
+            auto* high = outputs[numBands - 1].data();
+
+            for (int n = 0; n < partitionSize; ++n)
+                high[n] = historyData[(historyIndex + n - firCenter + historySize) % historySize];
+
+            for (int band = 0; band < numSplits; ++band)
+            {
+                auto* out = outputs[(size_t)band].data();
+                convolve(slots[(size_t)currentSlot], ch, band, out);
+
+                if (previousSlot >= 0)
+                {
+                    // Кроссфейд за шаг: старые фильтры -> новые
+                    convolve(slots[(size_t)previousSlot], ch, band, fadeBuffer.data());
+                    const float step = 1.0f / (float)partitionSize;
+                    for (int n = 0; n < partitionSize; ++n)
+                    {
+                        const float fade = (float)(n + 1) * step;
+                        out[n] = fadeBuffer[(size_t)n] + fade * (out[n] - fadeBuffer[(size_t)n]);
+                    }
+                }
+
+                juce::FloatVectorOperations::subtract(high, out, partitionSize);
+            }
+        }
+
+        historyIndex = (historyIndex + partitionSize) % historySize;
+        delayLineIndex = (delayLineIndex + 1) % numPartitions;
+
+        if (previousSlot >= 0)
+        {
+            slots[(size_t)previousSlot].state.store(FilterSlot::free, std::memory_order_release);
+            previousSlot = -1;
+        }
+    }
+
+    void LinearPhaseCrossover::convolve(const FilterSlot& slot, int channel, int band, float* output) noexcept
+    {
+        // Overlap-save: сумма X(шаг - k) * H(k) по частям, верны последние P отсчетов кадра
+        const int numBins = partitionSize + 1;
+        const int spectrumSize = 2 * numBins;
+        auto* acc = accumulator.data();
+        std::fill(acc, acc + spectrumSize, 0.0f);
+
+        const auto* delayLine = frequencyDelayLine[(size_t)channel].data();
+        const auto* filter = slot.spectra.data() + (size_t)(band * numPartitions * spectrumSize);
+
+        for (int part = 0; part < numPartitions; ++part)
+        {
+            const int index = (delayLineIndex - part + numPartitions) % numPartitions;
+            const auto* x = delayLine + index * spectrumSize;
+            const auto* h = filter + part * spectrumSize;
+
+            for (int k = 0; k < spectrumSize; k += 2)
+            {
+                acc[k] += x[k] * h[k] - x[k + 1] * h[k + 1];
+                acc[k + 1] += x[k] * h[k + 1] + x[k + 1] * h[k];
+            }
+        }
+
+        // Бины выше Найквиста - комплексно сопряженное зеркало
+        const int fftSize = 2 * partitionSize;
+        for (int k = numBins; k < fftSize; ++k)
+        {
+            acc[2 * k] = acc[2 * (fftSize - k)];
+            acc[2 * k + 1] = -acc[2 * (fftSize - k) + 1];
+        }
+
+        fft->performRealOnlyInverseTransform(acc);
+        std::copy(acc + partitionSize, acc + fftSize, output);
+    }
+}
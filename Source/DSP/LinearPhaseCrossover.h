@@ -0,0 +1,113 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Линейно-фазовый кроссовер на 4 полосы: свертка с FIR полос по схеме
+    // uniformly partitioned overlap-save (UPOLS). FIR длиной numPartitions * P
+    // режется на numPartitions частей по P отсчетов; вход раз в P отсчетов проходит один FFT
+    // размера 2P и попадает в частотную линию задержки, выход полосы - сумма произведений
+    // спектров частей и один обратный FFT.
+    //
+    // Бюджет CPU: число частей фиксировано, длина FIR (зависит от частоты дискретизации)
+    // меняет только P. На отсчет приходится ~log2(P) работы FFT и постоянное число
+    // умножений спектров, поэтому стоимость от длины FIR почти не зависит.
+    // Работа идет раз в шаг P (кадрирование как у SpectralBandSplitter).
+    //
+    // Полосы Low, Low-Mid, Mid-High - свертка, High - задержанный вход минус их сумма,
+    // поэтому сумма полос в точности равна входу с задержкой getLatencySamples().
+    //
+    // FIR считаются в фоновом потоке после setCrossoverFrequencies() и передаются
+    // аудиопотоку без блокировок (слоты с атомарным состоянием); смена фильтров -
+    // с кроссфейдом длиной в один шаг (в этом шаге свертка считается дважды).
+    class LinearPhaseCrossover
+    {
+    public:
+        static constexpr int numBands = 4;
+        static constexpr int numSplits = numBands - 1;
+        static constexpr int numChannels = 2;
+        static constexpr int numPartitions = 8;
+        static constexpr double firLengthSeconds = 0.085; // Разрешение по частоте у нижнего кроссовера
+
+        LinearPhaseCrossover();
+        ~LinearPhaseCrossover();
+
+        // Фильтры для начальных частот считаются сразу, затем запускается фоновый поток
+        void prepare(const juce::dsp::ProcessSpec& spec, const std::array<float, numSplits>& initialCutoffs);
+
+        // Останавливает фоновый поток (режим выключен)
+        void release();
+        void reset();
+
+        // Любой поток, без блокировок: новые FIR посчитает фоновый поток
+        void setCrossoverFrequencies(const std::array<float, numSplits>& cutoffs) noexcept;
+
+        // input - L/R, bands[b] - L/R буферы полосы b (не должны совпадать со входом)
+        void processStereo(const float* const* input, const std::array<float* const*, numBands>& bands,
+                           int numSamples) noexcept;
+
+        int getLatencySamples() const noexcept { return latencySamples; }
+        static int getLatencySamples(double sampleRate) noexcept;
+
+    private:
+        class DesignThread : public juce::Thread
+        {
+        public:
+            explicit DesignThread(LinearPhaseCrossover& ownerToUse) : juce::Thread("MBRP FIR design"), owner(ownerToUse) {}
+            void run() override;
+
+        private:
+            LinearPhaseCrossover& owner;
+        };
+
+        // Спектры частей FIR полос (numSplits x numPartitions x (P + 1) комплексных, re/im подряд)
+        struct FilterSlot
+        {
+            enum State { free = 0, writing, ready, inUse };
+            std::atomic<int> state{ free };
+            juce::uint32 generation = 0;
+            std::vector<float> spectra;
+        };
+        static constexpr int numSlots = 4; // Текущий, уходящий при кроссфейде, и два для фонового потока
+
+        static int getPartitionSize(double sampleRate) noexcept;
+
+        double sampleRate = 44100.0;
+        int partitionSize = 0;  // P
+        int latencySamples = 0; // P (кадрирование) + центр FIR
+        int firCenter = 0;
+
+        // --- Аудиопоток ---
+        std::unique_ptr<juce::dsp::FFT> fft;                            // Размер 2P
+        std::array<std::vector<float>, numChannels> inputFrame;         // 2P: предыдущий и текущий шаг
+        std::array<std::vector<float>, numChannels> frequencyDelayLine; // numPartitions спектров входа
+        std::array<std::vector<float>, numChannels> history;            // Вход для полосы High (задержка firCenter)
+        std::array<std::array<std::vector<float>, numBands>, numChannels> outputFifo;
+        std::vector<float> accumulator, fadeBuffer;
+        int fill = 0, delayLineIndex = 0, historyIndex = 0;
+        int currentSlot = -1, previousSlot = -1;
+        juce::uint32 currentGeneration = 0;
+
+        // --- Фоновый поток ---
+        std::array<FilterSlot, numSlots> slots;
+        std::array<std::atomic<float>, numSplits> requestedCutoffs;
+        std::atomic<juce::uint32> requestedGeneration{ 0 };
+        juce::uint32 designedGeneration = 0;
+        std::unique_ptr<juce::dsp::FFT> designFft;
+        std::vector<float> designFir, designLowpass, designBuffer;
+        DesignThread designThread{ *this };
+
+        void designPendingFilters();
+        void designFilters(const std::array<float, numSplits>& cutoffs, FilterSlot& slot);
+
+        void processHop() noexcept;
+        void pickUpNewFilters() noexcept;
+        void convolve(const FilterSlot& slot, int channel, int band, float* output) noexcept;
+    };
+}
@@ -0,0 +1,357 @@
+#include "MultiBandReverb.h"
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    void MultiBandReverb::CombFilter::setSize(int size)
+    {
+        buffer.assign((size_t)juce::jmax(1, size), Vec::expand(0.0f));
+        index = 0;
+        last = Vec::expand(0.0f);
+    }
+
+    void MultiBandReverb::CombFilter::clear()
+    {
+        std::fill(buffer.begin(), buffer.end(), Vec::expand(0.0f));
+        index = 0;
+        last = Vec::expand(0.0f);
+    }
+
+    void MultiBandReverb::AllPassFilter::setSize(int size)
+    {
+        buffer.assign((size_t)juce::jmax(1, size), Vec::expand(0.0f));
+        index = 0;
+    }
+
+    void MultiBandReverb::AllPassFilter::clear()
+    {
+        std::fill(buffer.begin(), buffer.end(), Vec::expand(0.0f));
+        index = 0;
+    }
+
+    //==============================================================================
+    void MultiBandReverb::LaneSmoother::reset(double newSampleRate, double rampLengthSeconds)
+    {
+        stepsToTarget = (int)std::floor(rampLengthSeconds * newSampleRate);
+        current = target;
+        step.fill(0.0f);
+        countdown = 0;
+    }
+
+    void MultiBandReverb::LaneSmoother::setTarget(int lane, float newValue)
+    {
+        if (target[(size_t)lane] == newValue)
+            return;
+
+        target[(size_t)lane] = newValue;
+
+        if (stepsToTarget <= 0)
+        {
+            current = target;
+            countdown = 0;
+            return;
+        }
+
+        countdown = stepsToTarget;
+        updateSteps();
+    }
+
+    void MultiBandReverb::LaneSmoother::setCurrentAndTarget(int lane, float newValue)
+    {
+        target[(size_t)lane] = current[(size_t)lane] = newValue;
+
+        if (countdown > 0)
+            updateSteps();
+    }
+
+    void MultiBandReverb::LaneSmoother::updateSteps()
+    {
+        for (size_t i = 0; i < (size_t)numLanes; ++i)
+            step[i] = (target[i] - current[i]) / (float)countdown;
+    }
+
+    MultiBandReverb::Vec MultiBandReverb::LaneSmoother::getNextValue() noexcept
+    {
+        if (countdown > 0)
+        {
+            if (--countdown == 0)
+                current = target;
+            else
+                (Vec::fromRawArray(current.data()) + Vec::fromRawArray(step.data())).copyToRawArray(current.data());
+        }
+
+        return Vec::fromRawArray(current.data());
+    }
+
+    //==============================================================================
+    MultiBandReverb::MultiBandReverb()
+    {
+        for (auto& p : parameters)
+        {
+            p.wetLevel = 1.0f;
+            p.dryLevel = 0.0f;
+            p.width = 1.0f;
+            p.freezeMode = 0.0f;
+            p.roomSize = 0.5f;
+            p.damping = 0.5f;
+        }
+
+        for (int lane = 0; lane < numLanes; ++lane)
+            updateLane(lane);
+    }
+
+    void MultiBandReverb::prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        jassert(spec.numChannels == (juce::uint32)numChannels);
+        sampleRate = spec.sampleRate;
+
+        // Настройки Freeverb (как в juce::Reverb::setSampleRate)
+        static const short combTunings[] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 }; // при 44100 Гц
+        static const short allPassTunings[] = { 556, 441, 341, 225 };
+        const int stereoSpread = 23;
+        const int intSampleRate = (int)sampleRate;
+
+        for (int i = 0; i < numCombs; ++i)
+        {
+            combs[0][(size_t)i].setSize((intSampleRate * combTunings[i]) / 44100);
+            combs[1][(size_t)i].setSize((intSampleRate * (combTunings[i] + stereoSpread)) / 44100);
+        }
+
+        for (int i = 0; i < numAllPasses; ++i)
+        {
+            allPasses[0][(size_t)i].setSize((intSampleRate * allPassTunings[i]) / 44100);
+            allPasses[1][(size_t)i].setSize((intSampleRate * (allPassTunings[i] + stereoSpread)) / 44100);
+        }
+
+        for (auto* s : { &damping, &feedback, &dryGain, &wetGain1, &wetGain2 })
+            s->reset(sampleRate, smoothingTimeSeconds);
+
+        maxBlockSize = juce::jmax(1, (int)spec.maximumBlockSize);
+        for (auto* v : { &scratch.inL, &scratch.inR, &scratch.input, &scratch.damping, &scratch.feedback,
+                         &scratch.dry, &scratch.wet1, &scratch.wet2, &scratch.networkOut[0], &scratch.networkOut[1] })
+            v->assign((size_t)maxBlockSize, Vec::expand(0.0f));
+    }
+
+    void MultiBandReverb::reset()
+    {
+        for (auto& channelCombs : combs)
+            for (auto& c : channelCombs)
+                c.clear();
+
+        for (auto& channelAllPasses : allPasses)
+            for (auto& a : channelAllPasses)
+                a.clear();
+    }
+
+    void MultiBandReverb::release()
+    {
+        for (auto& channelCombs : combs)
+            for (auto& c : channelCombs)
+                std::vector<Vec>().swap(c.buffer);
+
+        for (auto& channelAllPasses : allPasses)
+            for (auto& a : channelAllPasses)
+                std::vector<Vec>().swap(a.buffer);
+
+        for (auto* v : { &scratch.inL, &scratch.inR, &scratch.input, &scratch.damping, &scratch.feedback,
+                         &scratch.dry, &scratch.wet1, &scratch.wet2, &scratch.networkOut[0], &scratch.networkOut[1] })
+            std::vector<Vec>().swap(*v);
+        maxBlockSize = 0;
+    }
+
+    void MultiBandReverb::resetLane(int lane)
+    {
+        jassert(lane >= 0 && lane < numLanes);
+
+        auto clearLane = [lane](Vec& v) { v.set((size_t)lane, 0.0f); };
+
+        for (auto& channelCombs : combs)
+        {
+            for (auto& c : channelCombs)
+            {
+                for (auto& v : c.buffer)
+                    clearLane(v);
+                clearLane(c.last);
+            }
+        }
+
+        for (auto& channelAllPasses : allPasses)
+            for (auto& a : channelAllPasses)
+                for (auto& v : a.buffer)
+                    clearLane(v);
+    }
+
+    void MultiBandReverb::setParameters(int lane, const Parameters& newParams)
+    {
+        jassert(lane >= 0 && lane < numLanes);
+        parameters[(size_t)lane] = newParams;
+        updateLane(lane);
+    }
+
+    void MultiBandReverb::updateLane(int lane)
+    {
+        // Масштабирование как в juce::Reverb::setParameters / updateDamping
+        const float wetScaleFactor = 3.0f;
+        const float dryScaleFactor = 2.0f;
+        const float roomScaleFactor = 0.28f;
+        const float roomOffset = 0.7f;
+        const float dampScaleFactor = 0.4f;
+
+        const auto& p = parameters[(size_t)lane];
+        const bool frozen = p.freezeMode >= 0.5f;
+        const float wet = p.wetLevel * wetScaleFactor;
+
+        dryGain.setTarget(lane, p.dryLevel * dryScaleFactor);
+        wetGain1.setTarget(lane, 0.5f * wet * (1.0f + p.width));
+        wetGain2.setTarget(lane, 0.5f * wet * (1.0f - p.width));
+        inputGain[(size_t)lane] = frozen ? 0.0f : 0.015f;
+
+        damping.setTarget(lane, frozen ? 0.0f : p.damping * dampScaleFactor);
+        feedback.setTarget(lane, frozen ? 1.0f : p.roomSize * roomScaleFactor + roomOffset);
+    }
+
+    void MultiBandReverb::process(const std::array<float* const*, numLanes>& bandChannels, int numSamples) noexcept
+    {
+        jassert(maxBlockSize > 0); // prepare() не вызывался
+
+        // Блоки длиннее maximumBlockSize режутся на части
+        for (int start = 0; start < numSamples; start += maxBlockSize)
+        {
+            const int n = juce::jmin(maxBlockSize, numSamples - start);
+
+            float* offsetChannels[numLanes][numChannels] = {};
+            std::array<float* const*, numLanes> chunk{};
+            for (size_t lane = 0; lane < (size_t)numLanes; ++lane)
+            {
+                if (auto* const* ch = bandChannels[lane])
+                {
+                    offsetChannels[lane][0] = ch[0] + start;
+                    offsetChannels[lane][1] = ch[1] + start;
+                    chunk[lane] = offsetChannels[lane];
+                }
+            }
+
+            beginBlock(chunk, n);
+            processNetwork(0, n);
+            processNetwork(1, n);
+            endBlock(n);
+        }
+    }
+
+    void MultiBandReverb::beginBlock(const std::array<float* const*, numLanes>& bandChannels, int numSamples) noexcept
+    {
+        jassert(numSamples <= maxBlockSize);
+        blockChannels = bandChannels;
+
+        numBlockLanes = 0;
+        for (int lane = 0; lane < numLanes; ++lane)
+            if (bandChannels[(size_t)lane] != nullptr)
+                blockLanes[(size_t)numBlockLanes++] = lane;
+
+        // Свободные линии остаются нулями весь блок
+        alignas(16) float inL[numLanes] = {};
+        alignas(16) float inR[numLanes] = {};
+
+        const Vec gain = Vec::fromRawArray(inputGain.data());
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // Сбор отсчетов полос в линии регистра
+            for (int k = 0; k < numBlockLanes; ++k)
+            {
+                const int lane = blockLanes[(size_t)k];
+                auto* const* ch = bandChannels[(size_t)lane];
+                inL[lane] = ch[0][i];
+                inR[lane] = ch[1][i];
+            }
+
+            const auto idx = (size_t)i;
+            scratch.inL[idx] = Vec::fromRawArray(inL);
+            scratch.inR[idx] = Vec::fromRawArray(inR);
+            scratch.input[idx] = (scratch.inL[idx] + scratch.inR[idx]) * gain;
+
+            scratch.damping[idx] = damping.getNextValue();
+            scratch.feedback[idx] = feedback.getNextValue();
+            scratch.dry[idx] = dryGain.getNextValue();
+            scratch.wet1[idx] = wetGain1.getNextValue();
+            scratch.wet2[idx] = wetGain2.getNextValue();
+        }
+    }
+
+    void MultiBandReverb::processNetwork(int channel, int numSamples) noexcept
+    {
+        jassert(channel >= 0 && channel < numChannels);
+
+        auto& channelCombs = combs[(size_t)channel];
+        auto& channelAllPasses = allPasses[(size_t)channel];
+        auto& out = scratch.networkOut[(size_t)channel];
+
+        const Vec one = Vec::expand(1.0f);
+        const Vec half = Vec::expand(0.5f);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto idx = (size_t)i;
+            const Vec input = scratch.input[idx];
+            const Vec damp = scratch.damping[idx];
+            const Vec oneMinusDamp = one - damp;
+            const Vec feedbck = scratch.feedback[idx];
+
+            Vec acc = Vec::expand(0.0f);
+
+            for (auto& c : channelCombs)
+            {
+                const Vec y = c.buffer[(size_t)c.index];
+                c.last = y * oneMinusDamp + c.last * damp;
+                JUCE_UNDENORMALISE(c.last);
+
+                Vec temp = input + c.last * feedbck;
+                JUCE_UNDENORMALISE(temp);
+                c.buffer[(size_t)c.index] = temp;
+                if (++c.index >= (int)c.buffer.size()) c.index = 0;
+                acc += y;
+            }
+
+            for (auto& a : channelAllPasses)
+            {
+                const Vec buf = a.buffer[(size_t)a.index];
+                Vec temp = acc + buf * half;
+                JUCE_UNDENORMALISE(temp);
+                a.buffer[(size_t)a.index] = temp;
+                if (++a.index >= (int)a.buffer.size()) a.index = 0;
+                acc = buf - acc;
+            }
+
+            out[idx] = acc;
+        }
+    }
+
+    void MultiBandReverb::endBlock(int numSamples) noexcept
+    {
+        alignas(16) float outL[numLanes];
+        alignas(16) float outR[numLanes];
+
+        const auto& accL = scratch.networkOut[0];
+        const auto& accR = scratch.networkOut[1];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto idx = (size_t)i;
+            const Vec dry = scratch.dry[idx];
+            const Vec wet1 = scratch.wet1[idx];
+            const Vec wet2 = scratch.wet2[idx];
+
+            (accL[idx] * wet1 + accR[idx] * wet2 + scratch.inL[idx] * dry).copyToRawArray(outL);
+            (accR[idx] * wet1 + accL[idx] * wet2 + scratch.inR[idx] * dry).copyToRawArray(outR);
+
+            // Раскладка результата обратно по буферам полос
+            for (int k = 0; k < numBlockLanes; ++k)
+            {
+                const int lane = blockLanes[(size_t)k];
+                auto* const* ch = blockChannels[(size_t)lane];
+                ch[0][i] = outL[lane];
+                ch[1][i] = outR[lane];
+            }
+        }
+    }
+}
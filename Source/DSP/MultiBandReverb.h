@@ -0,0 +1,138 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Ревербератор Freeverb (та же топология и настройки, что и у juce::Reverb),
+    // в котором четыре полосы упакованы в четыре линии juce::dsp::SIMDRegister<float>.
+    // Длины гребенчатых и всепропускающих фильтров у полос одинаковые, поэтому
+    // один проход по сети обрабатывает сразу все полосы; roomSize/damping/wet/width
+    // задаются отдельно для каждой линии.
+    //
+    // Гребенчатые и всепропускающие фильтры обновляются как в juce::Reverb, включая
+    // JUCE_UNDENORMALISE после каждой записи (на Intel это +0.1f/-0.1f, которое заодно
+    // округляет малые значения). Поэтому при постоянных параметрах каждая линия совпадает
+    // с juce::Reverb отсчет в отсчет. Во время сглаживания возможны отличия:
+    // LaneSmoother пересчитывает шаг всех линий при смене цели в любой из них.
+    //
+    // Неиспользуемая линия (nullptr в process/beginBlock) получает на вход нули:
+    // ее хвост продолжает затухать, а не замораживается, как у невызываемого juce::Reverb.
+    class MultiBandReverb
+    {
+    public:
+        using Vec = juce::dsp::SIMDRegister<float>;
+        using Parameters = juce::dsp::Reverb::Parameters;
+
+        static constexpr int numLanes = 4;
+        static constexpr int numChannels = 2;
+        static_assert(Vec::SIMDNumElements == numLanes, "Одна полоса на линию SIMD-регистра");
+
+        MultiBandReverb();
+
+        void prepare(const juce::dsp::ProcessSpec& spec);
+        void reset();
+
+        // Освобождает память фильтров и промежуточных буферов (экземпляр не используется).
+        // Параметры сохраняются; до следующего prepare() process() вызывать нельзя.
+        void release();
+
+        // Длина линейного сглаживания roomSize/damping/wet по отсчетам (по умолчанию 10 мс,
+        // как у juce::Reverb). Применяется в prepare().
+        void setSmoothingTime(double seconds) { smoothingTimeSeconds = seconds; }
+
+        // Очищает состояние одной полосы (линии), не трогая остальные
+        void resetLane(int lane);
+
+        // Параметры полосы lane (как у juce::dsp::Reverb::setParameters)
+        void setParameters(int lane, const Parameters& newParams);
+        const Parameters& getParameters(int lane) const { return parameters[(size_t)lane]; }
+
+        // bandChannels[lane] - указатели на L/R буферы полосы (in-place).
+        // nullptr - линия не используется в этом блоке: на вход подаются нули,
+        // буфер полосы не трогается, сбор и раскладка по отсчетам идут только по занятым линиям.
+        // Стоимость сетей от числа занятых линий не зависит (один векторный проход на все четыре),
+        // поэтому вызывающая сторона пропускает экземпляр целиком, если занятых линий нет.
+        void process(const std::array<float* const*, numLanes>& bandChannels, int numSamples) noexcept;
+
+        // Та же обработка по шагам - для распараллеливания по каналам (см. RealtimeThreadPool).
+        // Сети L и R делят только вход, поэтому processNetwork(0) и processNetwork(1)
+        // независимы и могут идти в разных потоках между beginBlock() и endBlock().
+        // numSamples не больше spec.maximumBlockSize; результат совпадает с process().
+        void beginBlock(const std::array<float* const*, numLanes>& bandChannels, int numSamples) noexcept;
+        void processNetwork(int channel, int numSamples) noexcept;
+        void endBlock(int numSamples) noexcept;
+
+        int getMaximumBlockSize() const noexcept { return maxBlockSize; }
+
+    private:
+        static constexpr int numCombs = 8;
+        static constexpr int numAllPasses = 4;
+
+        struct CombFilter
+        {
+            std::vector<Vec> buffer;
+            int index = 0;
+            Vec last;
+
+            void setSize(int size);
+            void clear();
+        };
+
+        struct AllPassFilter
+        {
+            std::vector<Vec> buffer;
+            int index = 0;
+
+            void setSize(int size);
+            void clear();
+        };
+
+        // Линейное сглаживание параметра во всех линиях сразу (аналог SmoothedValue).
+        // При смене цели в любой линии шаг пересчитывается для всех линий,
+        // поэтому все линии доходят до своих целей за одно и то же время.
+        struct LaneSmoother
+        {
+            alignas(16) std::array<float, numLanes> current{};
+            alignas(16) std::array<float, numLanes> target{};
+            alignas(16) std::array<float, numLanes> step{};
+            int stepsToTarget = 0;
+            int countdown = 0;
+
+            void reset(double sampleRate, double rampLengthSeconds);
+            void setTarget(int lane, float newValue);
+            void setCurrentAndTarget(int lane, float newValue);
+            Vec getNextValue() noexcept;
+
+        private:
+            void updateSteps();
+        };
+
+        std::array<std::array<CombFilter, numCombs>, numChannels> combs;
+        std::array<std::array<AllPassFilter, numAllPasses>, numChannels> allPasses;
+
+        // Промежуточные значения блока по отсчетам: вход, сглаженные параметры, выходы сетей
+        struct BlockScratch
+        {
+            std::vector<Vec> inL, inR, input, damping, feedback, dry, wet1, wet2;
+            std::array<std::vector<Vec>, numChannels> networkOut;
+        };
+        BlockScratch scratch;
+        std::array<float* const*, numLanes> blockChannels{};
+        std::array<int, numLanes> blockLanes{}; // Линии с буфером в текущем блоке
+        int numBlockLanes = 0;
+        int maxBlockSize = 0;
+
+        std::array<Parameters, numLanes> parameters;
+        LaneSmoother damping, feedback, dryGain, wetGain1, wetGain2;
+        alignas(16) std::array<float, numLanes> inputGain{};
+
+        double sampleRate = 44100.0;
+        double smoothingTimeSeconds = 0.01;
+
+        void updateLane(int lane);
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Версионированный снимок изменений параметров без блокировок.
+    // У каждой группы параметров свой счетчик изменений: слушатель APVTS (любой поток)
+    // увеличивает счетчик, аудиопоток сравнивает его с последней увиденной версией
+    // и пересчитывает коэффициенты только для изменившихся групп.
+    template <int NumGroups>
+    class ParameterChangeTracker
+    {
+    public:
+        ParameterChangeTracker()
+        {
+            for (auto& v : versions)
+                v.store(1, std::memory_order_relaxed); // seen = 0 -> первый блок пересчитывает всё
+        }
+
+        // Любой поток
+        void markChanged(int group) noexcept
+        {
+            jassert(group >= 0 && group < NumGroups);
+            versions[(size_t)group].fetch_add(1, std::memory_order_release);
+        }
+
+        void markAllChanged() noexcept
+        {
+            for (int g = 0; g < NumGroups; ++g)
+                markChanged(g);
+        }
+
+        // Только аудиопоток: true, если группа изменилась с прошлого вызова
+        bool consumeChange(int group) noexcept
+        {
+            jassert(group >= 0 && group < NumGroups);
+            const auto v = versions[(size_t)group].load(std::memory_order_acquire);
+            if (v == seen[(size_t)group])
+                return false;
+
+            seen[(size_t)group] = v;
+            return true;
+        }
+
+    private:
+        std::array<std::atomic<juce::uint32>, NumGroups> versions;
+        std::array<juce::uint32, NumGroups> seen{};
+    };
+}
@@ -0,0 +1,117 @@
+#include "ParameterRamp.h"
+
+namespace MBRP_DSP
+{
+    void ParameterRamp::prepare(double sampleRate, int maxBlockSize, float timeMs, Type rampType)
+    {
+        jassert(sampleRate > 0.0 && maxBlockSize > 0 && timeMs >= 0.0f);
+
+        type = rampType;
+        const double timeSamples = (double)timeMs * 0.001 * sampleRate;
+
+        rampLengthSamples = (int)std::floor(timeSamples);
+
+        decayTable.resize((size_t)juce::jmax(1, maxBlockSize));
+        const double a = timeSamples > 0.0 ? std::exp(-1.0 / timeSamples) : 0.0;
+        double power = 1.0;
+        for (auto& d : decayTable)
+        {
+            power *= a;
+            d = (float)power;
+        }
+
+        setCurrentAndTarget(target);
+    }
+
+    void ParameterRamp::setTarget(float newTarget) noexcept
+    {
+        if (newTarget == target)
+            return;
+
+        target = newTarget;
+
+        if ((type == Type::linear && rampLengthSamples <= 0) || decayTable.empty() || decayTable[0] <= 0.0f)
+        {
+            setCurrentAndTarget(newTarget);
+            return;
+        }
+
+        ramping = true;
+        countdown = rampLengthSamples;
+        step = (target - current) / (float)juce::jmax(1, countdown);
+    }
+
+    void ParameterRamp::setCurrentAndTarget(float newValue) noexcept
+    {
+        current = target = newValue;
+        ramping = false;
+        countdown = 0;
+        step = 0.0f;
+    }
+
+    int ParameterRamp::processChunk(float* dest, int numSamples) noexcept
+    {
+        if (type == Type::linear)
+        {
+            const int n = juce::jmin(numSamples, countdown);
+            const float start = current, s = step;
+
+            if (dest != nullptr)
+                for (int i = 0; i < n; ++i)
+                    dest[i] = start + s * (float)(i + 1);
+
+            countdown -= n;
+            if (countdown == 0)
+            {
+                current = target;
+                ramping = false;
+            }
+            else
+            {
+                current = start + s * (float)n;
+            }
+            return n;
+        }
+
+        const int n = juce::jmin(numSamples, (int)decayTable.size());
+        const float diff = current - target, t = target;
+        const float* decay = decayTable.data();
+
+        if (dest != nullptr)
+            for (int i = 0; i < n; ++i)
+                dest[i] = t + diff * decay[i];
+
+        const float remaining = diff * decay[n - 1];
+
+        // Остаток ниже точности float относительно цели - рампа закончена
+        if (std::abs(remaining) <= 1.0e-6f * juce::jmax(1.0f, std::abs(t)))
+        {
+            current = target;
+            ramping = false;
+        }
+        else
+        {
+            current = t + remaining;
+        }
+        return n;
+    }
+
+    void ParameterRamp::render(float* dest, int numSamples) noexcept
+    {
+        int done = 0;
+        while (ramping && done < numSamples)
+            done += processChunk(dest + done, numSamples - done);
+
+        if (done < numSamples)
+            juce::FloatVectorOperations::fill(dest + done, current, numSamples - done);
+    }
+
+    float ParameterRamp::advance(int numSamples) noexcept
+    {
+        int done = 0;
+        while (ramping && done < numSamples)
+            done += processChunk(nullptr, numSamples - done);
+
+        return current;
+    }
+}
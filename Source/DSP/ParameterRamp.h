@@ -0,0 +1,55 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Сглаживание непрерывного параметра по отсчетам с постоянной времени в мс,
+    // не зависящей от размера блока хоста.
+    //  - linear: за timeMs значение линейно доходит до цели;
+    //  - exponential: однополюсное сглаживание, timeMs - постоянная времени (до 63%).
+    //
+    // render() заполняет буфер значениями на каждый отсчет в замкнутой форме
+    // (current + step * (i + 1) или target + diff * a^(i + 1) по заранее посчитанной
+    // таблице степеней), без зависимости между соседними отсчетами, поэтому цикл
+    // векторизуется компилятором. advance() продвигает рампу без заполнения буфера -
+    // для параметров, которые пересчитываются раз в блок (частоты кроссовера).
+    class ParameterRamp
+    {
+    public:
+        enum class Type { linear, exponential };
+
+        // maxBlockSize - длина таблицы степеней для exponential (большие блоки режутся на части)
+        void prepare(double sampleRate, int maxBlockSize, float timeMs, Type rampType);
+
+        void setTarget(float newTarget) noexcept;
+        void setCurrentAndTarget(float newValue) noexcept;
+
+        bool isRamping() const noexcept { return ramping; }
+        float getCurrentValue() const noexcept { return current; }
+        float getTargetValue() const noexcept { return target; }
+
+        // dest[i] - значение на i-м отсчете блока; после вызова current = dest[numSamples - 1]
+        void render(float* dest, int numSamples) noexcept;
+
+        // То же без буфера; возвращает значение в конце блока
+        float advance(int numSamples) noexcept;
+
+    private:
+        Type type = Type::linear;
+        float current = 0.0f, target = 0.0f;
+        bool ramping = false;
+
+        // linear
+        int rampLengthSamples = 0;
+        int countdown = 0;
+        float step = 0.0f;
+
+        // exponential: decayTable[i] = a^(i + 1)
+        std::vector<float> decayTable;
+
+        int processChunk(float* dest, int numSamples) noexcept;
+    };
+}
@@ -0,0 +1,124 @@
+#include "PreDelayLines.h"
+
+namespace MBRP_DSP
+{
+    void PreDelayLines::prepare(const std::vector<int>& maxDelaySamples, int newMaxBlockSize)
+    {
+        maxBlockSize = newMaxBlockSize;
+        lines.assign(maxDelaySamples.size(), Line{});
+
+        auto alignUp = [](size_t n) { return (n + alignmentFloats - 1) / alignmentFloats * alignmentFloats; };
+
+        size_t total = 0;
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            auto& line = lines[i];
+            line.maxDelay = juce::jmax(0, maxDelaySamples[i]);
+            line.size = line.maxDelay > 0 ? line.maxDelay + maxBlockSize + 2 : 0;
+            line.stride = alignUp((size_t)line.size);
+            line.offset = total;
+            total += line.stride * numChannels;
+        }
+
+        // Запас на выравнивание начала области
+        arena.assign(total + alignmentFloats, 0.0f);
+        arena.shrink_to_fit(); // Память освобождается и при переподготовке с меньшими линиями
+        const auto address = reinterpret_cast<std::uintptr_t>(arena.data());
+        const auto alignmentBytes = (std::uintptr_t)(alignmentFloats * sizeof(float));
+        arenaStart = (size_t)(((alignmentBytes - address % alignmentBytes) % alignmentBytes) / sizeof(float));
+
+        scratch.assign((size_t)maxBlockSize, 0.0f);
+        reset();
+    }
+
+    void PreDelayLines::reset()
+    {
+        for (int i = 0; i < (int)lines.size(); ++i)
+            resetLine(i);
+    }
+
+    void PreDelayLines::resetLine(int index) noexcept
+    {
+        auto& line = lines[(size_t)index];
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::fill(getRing(line, ch), getRing(line, ch) + line.size, 0.0f);
+        line.writeIndex = 0;
+    }
+
+    void PreDelayLines::write(float* ring, int size, int start, const float* source, int numSamples) noexcept
+    {
+        const int first = juce::jmin(numSamples, size - start);
+        juce::FloatVectorOperations::copy(ring + start, source, first);
+        juce::FloatVectorOperations::copy(ring, source + first, numSamples - first);
+    }
+
+    void PreDelayLines::read(const float* ring, int size, int start, float* dest, int numSamples) noexcept
+    {
+        const int first = juce::jmin(numSamples, size - start);
+        juce::FloatVectorOperations::copy(dest, ring + start, first);
+        juce::FloatVectorOperations::copy(dest + first, ring, numSamples - first);
+    }
+
+    void PreDelayLines::process(int index, float* const* channels, int numSamples, float delay) noexcept
+    {
+        auto& line = lines[(size_t)index];
+        jassert(numSamples <= maxBlockSize && line.size > 0);
+
+        line.delay = juce::jlimit(0.0f, (float)line.maxDelay, delay);
+        const int whole = (int)line.delay;
+        const float fraction = line.delay - (float)whole;
+
+        // Кольцо длиннее maxDelay + блок + 1, поэтому чтение не догоняет только что записанное
+        const int start = (line.writeIndex - whole + line.size) % line.size;
+        const int previous = (start - 1 + line.size) % line.size;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* ring = getRing(line, ch);
+            write(ring, line.size, line.writeIndex, channels[ch], numSamples);
+            read(ring, line.size, start, channels[ch], numSamples);
+
+            if (fraction > 0.0f)
+            {
+                // x[n - whole] + fraction * (x[n - whole - 1] - x[n - whole])
+                read(ring, line.size, previous, scratch.data(), numSamples);
+                juce::FloatVectorOperations::multiply(channels[ch], 1.0f - fraction, numSamples);
+                juce::FloatVectorOperations::addWithMultiply(channels[ch], scratch.data(), fraction, numSamples);
+            }
+        }
+
+        line.writeIndex = (line.writeIndex + numSamples) % line.size;
+    }
+
+    void PreDelayLines::process(int index, float* const* channels, int numSamples, const float* delays) noexcept
+    {
+        auto& line = lines[(size_t)index];
+        jassert(numSamples <= maxBlockSize && line.size > 0);
+
+        const float maxDelay = (float)line.maxDelay;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* ring = getRing(line, ch);
+            float* samples = channels[ch];
+            int writeIndex = line.writeIndex;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                ring[writeIndex] = samples[i];
+
+                const float delay = juce::jlimit(0.0f, maxDelay, delays[i]);
+                const int whole = (int)delay;
+                const float fraction = delay - (float)whole;
+                const int index1 = (writeIndex - whole + line.size) % line.size;
+                const int index2 = index1 == 0 ? line.size - 1 : index1 - 1;
+
+                samples[i] = ring[index1] + fraction * (ring[index2] - ring[index1]);
+                writeIndex = writeIndex + 1 == line.size ? 0 : writeIndex + 1;
+            }
+        }
+
+        if (numSamples > 0)
+            line.delay = juce::jlimit(0.0f, maxDelay, delays[numSamples - 1]);
+        line.writeIndex = (line.writeIndex + numSamples) % line.size;
+    }
+}
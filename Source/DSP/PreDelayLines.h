@@ -0,0 +1,62 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Линии пре-дилея всех полос в одной области памяти (вместо juce::dsp::DelayLine на полосу).
+    // Размер каждой линии задается в prepare() от частоты дискретизации и диапазона параметра,
+    // кольца каналов начинаются на границе 64 байт.
+    //
+    // Интерполяция линейная, как у DelayLine по умолчанию: y[n] = x[n - d].
+    // Блок с постоянной целой задержкой - два копирования (запись и чтение кольца) без
+    // интерполяции; дробная постоянная задержка - еще одно чтение и смешивание векторно.
+    class PreDelayLines
+    {
+    public:
+        static constexpr int numChannels = 2;
+        static constexpr int alignmentFloats = 16;
+
+        // maxDelaySamples[i] - наибольшая задержка линии i (0 - линия не используется)
+        void prepare(const std::vector<int>& maxDelaySamples, int maxBlockSize);
+        void reset();
+        void resetLine(int line) noexcept;
+
+        int getMaximumDelaySamples(int line) const noexcept { return lines[(size_t)line].maxDelay; }
+        float getDelay(int line) const noexcept { return lines[(size_t)line].delay; }
+        size_t getMemoryBytes() const noexcept { return arena.size() * sizeof(float); }
+
+        // In-place, L/R. Постоянная задержка на весь блок.
+        void process(int line, float* const* channels, int numSamples, float delay) noexcept;
+
+        // In-place, L/R. Задержка на каждый отсчет (пока идет рампа пре-дилея).
+        void process(int line, float* const* channels, int numSamples, const float* delays) noexcept;
+
+    private:
+        struct Line
+        {
+            size_t offset = 0; // Начало кольца L в arena; кольцо R - через stride
+            size_t stride = 0;
+            int size = 0;      // Длина кольца: maxDelay + maxBlockSize + 2
+            int maxDelay = 0;
+            int writeIndex = 0;
+            float delay = 0.0f;
+        };
+
+        std::vector<float> arena;
+        size_t arenaStart = 0; // Сдвиг до выравнивания data()
+        std::vector<Line> lines;
+        std::vector<float> scratch;
+        int maxBlockSize = 0;
+
+        float* getRing(const Line& line, int channel) noexcept
+        {
+            return arena.data() + arenaStart + line.offset + (size_t)channel * line.stride;
+        }
+
+        static void write(float* ring, int size, int start, const float* source, int numSamples) noexcept;
+        static void read(const float* ring, int size, int start, float* dest, int numSamples) noexcept;
+    };
+}
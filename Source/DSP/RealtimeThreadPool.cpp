@@ -0,0 +1,190 @@
+#include "RealtimeThreadPool.h"
+#include <algorithm>
+#include <array>
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+namespace MBRP_DSP
+{
+    namespace
+    {
+        // Подсказка процессору внутри цикла ожидания
+        inline void cpuRelax() noexcept
+        {
+           #if JUCE_INTEL
+            _mm_pause();
+           #elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+            __asm__ __volatile__ ("yield");
+           #endif
+        }
+    }
+
+    //==============================================================================
+    RealtimeThreadPool::Worker::Worker(RealtimeThreadPool& ownerPool, int index)
+        : juce::Thread("MBRP worker " + juce::String(index)), owner(ownerPool)
+    {
+    }
+
+    void RealtimeThreadPool::Worker::run()
+    {
+        // Режим FTZ/DAZ - свойство потока, ScopedNoDenormals аудиопотока сюда не доходит
+        const juce::ScopedNoDenormals noDenormals;
+        const auto spinTicks = (juce::int64)(juce::Time::getHighResolutionTicksPerSecond() * spinTimeMicroseconds * 1.0e-6);
+        auto seenGeneration = generationOf(owner.ticket.load(std::memory_order_acquire));
+
+        while (!threadShouldExit())
+        {
+            // Ждем новое поколение: сначала крутимся, потом спим до сигнала
+            auto spinStart = juce::Time::getHighResolutionTicks();
+            juce::uint64 t = owner.ticket.load(std::memory_order_acquire);
+
+            while (generationOf(t) == seenGeneration && !threadShouldExit())
+            {
+                if (juce::Time::getHighResolutionTicks() - spinStart < spinTicks)
+                {
+                    cpuRelax();
+                }
+                else
+                {
+                    sleeping.store(true, std::memory_order_seq_cst);
+                    if (generationOf(owner.ticket.load(std::memory_order_seq_cst)) == seenGeneration)
+                        wakeUp.wait(100);
+                    sleeping.store(false, std::memory_order_relaxed);
+                    spinStart = juce::Time::getHighResolutionTicks();
+                }
+
+                t = owner.ticket.load(std::memory_order_acquire);
+            }
+
+            seenGeneration = generationOf(t);
+            owner.runAvailableJobs(seenGeneration);
+        }
+    }
+
+    //==============================================================================
+    RealtimeThreadPool::RealtimeThreadPool()
+    {
+        const int numWorkers = juce::jlimit(0, maxWorkers, juce::SystemStats::getNumCpus() - 1);
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            workers.push_back(std::make_unique<Worker>(*this, i));
+            if (!workers.back()->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(10)))
+                workers.back()->startThread(juce::Thread::Priority::highest);
+        }
+    }
+
+    RealtimeThreadPool::~RealtimeThreadPool()
+    {
+        for (auto& w : workers)
+            w->signalThreadShouldExit();
+
+        for (auto& w : workers)
+        {
+            w->wakeUp.signal();
+            w->stopThread(1000);
+        }
+    }
+
+    void RealtimeThreadPool::runAvailableJobs(juce::uint32 generation) noexcept
+    {
+        auto t = ticket.load(std::memory_order_acquire);
+
+        for (;;)
+        {
+            if (generationOf(t) != generation)
+                return;
+
+            const int numJobs = numJobsOf(t);
+            const int next = nextJobOf(t);
+            if (next >= numJobs)
+                return;
+
+            if (ticket.compare_exchange_weak(t, packTicket(generation, numJobs, next + 1),
+                                             std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                // Пока задание не отмечено выполненным, поколение не завершится
+                // и currentJob/currentContext не будут перезаписаны
+                currentJob(currentContext, next);
+                jobsRemaining.fetch_sub(1, std::memory_order_acq_rel);
+                t = ticket.load(std::memory_order_acquire);
+            }
+        }
+    }
+
+    void RealtimeThreadPool::parallelFor(int numJobs, JobFunction job, void* context) noexcept
+    {
+        jassert(numJobs <= 0xffff);
+
+        if (numJobs <= 0)
+            return;
+
+        if (numJobs == 1 || workers.empty() || inUse.exchange(true, std::memory_order_acquire))
+        {
+            for (int i = 0; i < numJobs; ++i)
+                job(context, i);
+            return;
+        }
+
+        currentJob = job;
+        currentContext = context;
+        jobsRemaining.store(numJobs, std::memory_order_relaxed);
+
+        const auto generation = ++generationCounter;
+        ticket.store(packTicket(generation, numJobs, 0), std::memory_order_seq_cst);
+
+        for (auto& w : workers)
+            if (w->sleeping.exchange(false, std::memory_order_seq_cst))
+                w->wakeUp.signal();
+
+        runAvailableJobs(generation);
+
+        while (jobsRemaining.load(std::memory_order_acquire) > 0)
+            cpuRelax();
+
+        inUse.store(false, std::memory_order_release);
+    }
+
+    double RealtimeThreadPool::measureDispatchMicroseconds()
+    {
+        const juce::ScopedLock sl(measureLock);
+        if (measuredDispatchMicroseconds >= 0.0)
+            return measuredDispatchMicroseconds;
+        if (workers.empty())
+            return measuredDispatchMicroseconds = 0.0;
+
+        // Два задания: каждое отмечает свой старт и ждет старта второго (не дольше timeoutTicks).
+        // Одно берет вызывающий поток, второе - проснувшийся рабочий.
+        constexpr int numRuns = 9;
+        const auto ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+        const auto timeoutTicks = (juce::int64)(ticksPerSecond * 0.01);
+        std::array<double, numRuns> runs{};
+
+        for (auto& run : runs)
+        {
+            juce::Thread::sleep(2); // Рабочие потоки докручиваются и засыпают
+
+            std::array<std::atomic<juce::int64>, 2> started{};
+            auto probe = [&started, timeoutTicks](int index)
+            {
+                const auto start = juce::Time::getHighResolutionTicks();
+                started[(size_t)index].store(start, std::memory_order_release);
+
+                auto& other = started[(size_t)(1 - index)];
+                while (other.load(std::memory_order_acquire) == 0
+                       && juce::Time::getHighResolutionTicks() - start < timeoutTicks)
+                    cpuRelax();
+            };
+
+            const auto begin = juce::Time::getHighResolutionTicks();
+            parallelFor(2, probe);
+            const auto lastStart = std::max(started[0].load(), started[1].load());
+            run = (double)(lastStart - begin) * 1.0e6 / ticksPerSecond;
+        }
+
+        std::sort(runs.begin(), runs.end());
+        return measuredDispatchMicroseconds = runs[(size_t)numRuns / 2];
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Пул рабочих потоков для fork-join внутри processBlock.
+    // Один пул на процесс - все экземпляры плагина держат его через
+    // juce::SharedResourcePointer<RealtimeThreadPool>.
+    //
+    // Потоки создаются заранее (в конструкторе, не в аудиопотоке). На горячем пути
+    // нет ни блокировок, ни выделения памяти: задание публикуется одним атомарным
+    // словом (поколение | число заданий | следующий индекс), потоки разбирают
+    // индексы через compare-exchange. Свободный поток сначала крутится
+    // spinTimeMicroseconds, затем засыпает на WaitableEvent; будят только уснувших.
+    // Задание, которое рабочий поток не успел взять, выполняет вызывающий поток,
+    // поэтому медленное пробуждение стоит времени, но не блокирует обработку.
+    //
+    // Если пул уже занят другим экземпляром (другой поток хоста), parallelFor
+    // не ждет, а выполняет задания последовательно в вызывающем потоке.
+    class RealtimeThreadPool
+    {
+    public:
+        using JobFunction = void (*)(void* context, int jobIndex);
+
+        // Заданий за раз немного (сети каналов реверба, полосы),
+        // поэтому больше трех помощников вызывающему потоку не нужно
+        static constexpr int maxWorkers = 3;
+
+        // Раздача идет раз в блок хоста (сотни мкс и больше), так что долгое кручение
+        // следующий блок не застает и только жжет ядра. Короткое покрывает подряд идущие
+        // processBlock нескольких экземпляров в одном callback хоста.
+        static constexpr double spinTimeMicroseconds = 20.0;
+
+        RealtimeThreadPool();
+        ~RealtimeThreadPool();
+
+        int getNumWorkers() const noexcept { return (int)workers.size(); }
+
+        // Выполняет job(context, i) для i из [0, numJobs) и возвращается, когда все готовы.
+        // Вызывающий поток тоже разбирает задания.
+        void parallelFor(int numJobs, JobFunction job, void* context) noexcept;
+
+        template <typename Callable>
+        void parallelFor(int numJobs, Callable& callable) noexcept
+        {
+            parallelFor(numJobs, [](void* ctx, int index) { (*static_cast<Callable*>(ctx))(index); }, &callable);
+        }
+
+        // Медиана задержки от parallelFor до старта задания в уснувшем рабочем потоке, мкс
+        // (так пул работает при блоках длиннее spinTimeMicroseconds). Замеряется один раз
+        // на процесс, занимает ~20 мс; только вне аудиопотока. Без рабочих потоков - 0.
+        double measureDispatchMicroseconds();
+
+    private:
+        class Worker : public juce::Thread
+        {
+        public:
+            Worker(RealtimeThreadPool& ownerPool, int index);
+            void run() override;
+
+            RealtimeThreadPool& owner;
+            juce::WaitableEvent wakeUp;
+            std::atomic<bool> sleeping{ false };
+        };
+
+        // Слово задания: [63..32] поколение, [31..16] число заданий, [15..0] следующий индекс
+        static constexpr juce::uint64 packTicket(juce::uint32 generation, int numJobs, int next) noexcept
+        {
+            return ((juce::uint64)generation << 32) | ((juce::uint64)(juce::uint32)numJobs << 16) | (juce::uint64)(juce::uint32)next;
+        }
+        static juce::uint32 generationOf(juce::uint64 t) noexcept { return (juce::uint32)(t >> 32); }
+        static int numJobsOf(juce::uint64 t) noexcept { return (int)((t >> 16) & 0xffff); }
+        static int nextJobOf(juce::uint64 t) noexcept { return (int)(t & 0xffff); }
+
+        // Забирает и выполняет задания текущего поколения, пока они есть
+        void runAvailableJobs(juce::uint32 generation) noexcept;
+
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        std::atomic<juce::uint64> ticket{ 0 };
+        std::atomic<int> jobsRemaining{ 0 };
+        std::atomic<bool> inUse{ false };
+        JobFunction currentJob = nullptr;
+        void* currentContext = nullptr;
+        juce::uint32 generationCounter = 0;
+
+        juce::CriticalSection measureLock;
+        double measuredDispatchMicroseconds = -1.0; // < 0 - еще не замерялось
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeThreadPool)
+    };
+}
@@ -0,0 +1,188 @@
+#include "SharedSpaceReverb.h"
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    void SharedSpaceReverb::Band::clear()
+    {
+        for (auto& b : buffer)
+            std::fill(b.begin(), b.end(), 0.0f);
+        lowpassState.fill(0.0f);
+    }
+
+    //==============================================================================
+    void SharedSpaceReverb::prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        jassert(spec.numChannels == (juce::uint32)numChannels);
+        sampleRate = spec.sampleRate;
+
+        // Времена отводов в мс при Space = 1 (взаимно простые, чтобы отражения не совпадали)
+        static const float tapTimesMs[numChannels][numEarlyTaps] = {
+            { 7.1f, 13.7f, 21.3f, 29.9f, 41.1f, 53.3f },
+            { 8.3f, 15.1f, 23.9f, 32.7f, 44.3f, 57.7f }
+        };
+        for (size_t ch = 0; ch < (size_t)numChannels; ++ch)
+            for (size_t t = 0; t < (size_t)numEarlyTaps; ++t)
+                tapDelays[ch][t] = tapTimesMs[ch][t] * 0.001f * (float)sampleRate;
+
+        // +2: линейная интерполяция дробного отвода
+        earlyBufferSize = (int)std::ceil(maxEarlyTimeSeconds * sampleRate) + 2;
+        writeIndex = 0;
+
+        for (auto& band : bands)
+        {
+            for (auto& b : band.buffer)
+                b.assign((size_t)earlyBufferSize, 0.0f);
+            band.lowpassState.fill(0.0f);
+
+            band.send.reset(sampleRate, smoothingTimeSeconds);
+            band.damping.reset(sampleRate, smoothingTimeSeconds);
+            band.tapScale.reset(sampleRate, smoothingTimeSeconds);
+            band.send.setCurrentAndTargetValue(band.sendTarget);
+            band.damping.setCurrentAndTargetValue(band.damping.getTargetValue());
+            band.tapScale.setCurrentAndTargetValue(getTapScale(band.space));
+        }
+
+        sendBus.setSize(numChannels, (int)spec.maximumBlockSize, false, true, true);
+        sendBus.clear();
+
+        late.prepare(spec);
+        updateLateParameters();
+    }
+
+    void SharedSpaceReverb::reset()
+    {
+        for (auto& band : bands)
+            band.clear();
+
+        writeIndex = 0;
+        sendBus.clear();
+        late.reset();
+    }
+
+    void SharedSpaceReverb::release()
+    {
+        for (auto& band : bands)
+            for (auto& b : band.buffer)
+                std::vector<float>().swap(b);
+
+        sendBus.setSize(numChannels, 0);
+        earlyBufferSize = 1;
+        writeIndex = 0;
+    }
+
+    void SharedSpaceReverb::resetBand(int band)
+    {
+        bands[(size_t)band].clear();
+    }
+
+    void SharedSpaceReverb::setBandParameters(int band, float space, float damping, float send)
+    {
+        auto& b = bands[(size_t)band];
+        b.space = space;
+        b.sendTarget = send;
+        b.send.setTargetValue(send);
+        b.damping.setTargetValue(juce::jlimit(0.0f, 0.99f, damping));
+        b.tapScale.setTargetValue(getTapScale(space));
+
+        updateLateParameters();
+    }
+
+    void SharedSpaceReverb::updateLateParameters()
+    {
+        float weightedSpace = 0.0f, totalSend = 0.0f;
+        for (const auto& b : bands)
+        {
+            weightedSpace += b.space * b.sendTarget;
+            totalSend += b.sendTarget;
+        }
+
+        juce::dsp::Reverb::Parameters params;
+        params.roomSize = totalSend > 0.0f ? weightedSpace / totalSend : 0.5f;
+        params.damping = lateDamping;
+        params.wetLevel = 1.0f;
+        params.dryLevel = 0.0f;
+        params.width = 1.0f;
+        params.freezeMode = 0.0f;
+        late.setParameters(params);
+    }
+
+    void SharedSpaceReverb::processBand(int band, float* const* channels, int numSamples) noexcept
+    {
+        jassert(numSamples <= sendBus.getNumSamples());
+        auto& b = bands[(size_t)band];
+
+        // Сглаженные значения на блок: посыл и демпфирование меняются медленно
+        const bool smoothing = b.send.isSmoothing() || b.damping.isSmoothing() || b.tapScale.isSmoothing();
+        const float sendStart = b.send.getCurrentValue();
+        const float sendEnd = smoothing ? b.send.skip(numSamples) : sendStart;
+        const float damp = smoothing ? b.damping.skip(numSamples) : b.damping.getCurrentValue();
+        const float scaleStart = b.tapScale.getCurrentValue();
+        const float scaleEnd = smoothing ? b.tapScale.skip(numSamples) : scaleStart;
+
+        const float sendStep = (sendEnd - sendStart) / (float)numSamples;
+        const float scaleStep = (scaleEnd - scaleStart) / (float)numSamples;
+        const bool sending = sendStart > 0.0f || sendEnd > 0.0f;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* samples = channels[ch];
+            auto* early = b.buffer[(size_t)ch].data();
+            const auto& delays = tapDelays[(size_t)ch];
+            auto* send = sendBus.getWritePointer(ch);
+            float lowpass = b.lowpassState[(size_t)ch];
+            int index = writeIndex;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float x = samples[i];
+                early[index] = x;
+
+                // Посыл в общую сеть: ФНЧ полосы, затем уровень
+                if (sending)
+                {
+                    lowpass = x * (1.0f - damp) + lowpass * damp;
+                    send[i] += lowpass * (sendStart + sendStep * (float)i);
+                }
+
+                const float scale = scaleStart + scaleStep * (float)i;
+                float y = 0.0f;
+                for (size_t t = 0; t < (size_t)numEarlyTaps; ++t)
+                {
+                    float readPos = (float)index - delays[t] * scale;
+                    if (readPos < 0.0f)
+                        readPos += (float)earlyBufferSize;
+                    if (readPos >= (float)earlyBufferSize) // -0.0000001f + size округляется до size
+                        readPos = 0.0f;
+
+                    const int i0 = (int)readPos;
+                    const int i1 = i0 + 1 < earlyBufferSize ? i0 + 1 : 0;
+                    const float frac = readPos - (float)i0;
+                    y += tapGains[t] * (early[i0] + frac * (early[i1] - early[i0]));
+                }
+                samples[i] = y;
+
+                if (++index >= earlyBufferSize)
+                    index = 0;
+            }
+
+            b.lowpassState[(size_t)ch] = lowpass;
+        }
+    }
+
+    void SharedSpaceReverb::processLate(float* const* output, int numSamples) noexcept
+    {
+        jassert(numSamples <= sendBus.getNumSamples());
+
+        // Все полосы пишут ранние отражения с одной позиции, позиция сдвигается раз в блок
+        writeIndex = (writeIndex + numSamples) % earlyBufferSize;
+
+        auto block = juce::dsp::AudioBlock<float>(sendBus).getSubBlock(0, (size_t)numSamples);
+        late.process(juce::dsp::ProcessContextReplacing<float>(block));
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::add(output[ch], sendBus.getReadPointer(ch), numSamples);
+
+        sendBus.clear(0, numSamples);
+    }
+}
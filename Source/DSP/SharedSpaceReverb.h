@@ -0,0 +1,83 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Реверб "общее пространство": вместо полной сети Freeverb на каждую полосу
+    // у каждой полосы только дешевые ранние отражения (многоотводная линия задержки),
+    // а поздний хвост считает одна общая стерео-сеть (juce::dsp::Reverb).
+    // Полоса попадает в общую сеть через посыл: ФНЧ с демпфированием полосы,
+    // затем уровень посыла. Размер общей сети - среднее Space полос, взвешенное по посылам.
+    //
+    // Порядок на блок: processBand() для каждой активной полосы, затем один processLate().
+    class SharedSpaceReverb
+    {
+    public:
+        static constexpr int maxBands = 8;
+        static constexpr int numChannels = 2;
+        static constexpr int numEarlyTaps = 6;
+        static constexpr double maxEarlyTimeSeconds = 0.08; // Последний отвод при Space = 1
+        static constexpr float lateDamping = 0.25f;         // Основное демпфирование - в посылах полос
+
+        void prepare(const juce::dsp::ProcessSpec& spec);
+        void reset();
+
+        // Освобождает буферы ранних отражений и посыла (движок не используется).
+        // Параметры полос сохраняются; до следующего prepare() process*() вызывать нельзя.
+        void release();
+
+        // Очищает ранние отражения и посыл одной полосы (общий хвост не трогается)
+        void resetBand(int band);
+
+        // Длина сглаживания посыла, демпфирования и размера отражений. Применяется в prepare().
+        void setSmoothingTime(double seconds) { smoothingTimeSeconds = seconds; }
+
+        // space - размер ранних отражений и вклад в размер общей сети, damping - ФНЧ посыла,
+        // send - линейный уровень посыла в общую сеть (0 - полоса в хвост не попадает)
+        void setBandParameters(int band, float space, float damping, float send);
+
+        // Заменяет сигнал полосы (in-place, L/R) ранними отражениями без сухого сигнала
+        // и добавляет демпфированный сигнал полосы в посыл общей сети
+        void processBand(int band, float* const* channels, int numSamples) noexcept;
+
+        // Пропускает накопленный посыл через общую сеть и добавляет хвост в output.
+        // Вызывается каждый блок, даже если полосы спят, чтобы хвост дозвучивал.
+        void processLate(float* const* output, int numSamples) noexcept;
+
+        // Самое дальнее раннее отражение в отсчетах (сигнал, еще "летящий" в отводах)
+        int getMaxEarlyDelaySamples() const noexcept { return earlyBufferSize - 1; }
+
+    private:
+        struct Band
+        {
+            std::array<std::vector<float>, numChannels> buffer;
+            std::array<float, numChannels> lowpassState{};
+            juce::SmoothedValue<float> send, damping, tapScale;
+            float space = 0.5f;
+            float sendTarget = 0.0f;
+
+            void clear();
+        };
+
+        std::array<Band, maxBands> bands;
+        int earlyBufferSize = 1;
+        int writeIndex = 0; // Общий для всех полос: каждая полоса пишет один блок за вызов
+
+        // Отводы ранних отражений в отсчетах при Space = 1 (L и R разные для ширины)
+        std::array<std::array<float, numEarlyTaps>, numChannels> tapDelays{};
+        static constexpr std::array<float, numEarlyTaps> tapGains{ 0.84f, 0.71f, 0.59f, 0.48f, 0.39f, 0.31f };
+
+        juce::dsp::Reverb late;
+        juce::AudioBuffer<float> sendBus; // Очищается в processLate()
+
+        double sampleRate = 44100.0;
+        double smoothingTimeSeconds = 0.05;
+
+        void updateLateParameters();
+        static float getTapScale(float space) noexcept { return 0.4f + 0.6f * juce::jlimit(0.0f, 1.0f, space); }
+    };
+}
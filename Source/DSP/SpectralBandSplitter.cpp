@@ -0,0 +1,188 @@
+#include "SpectralBandSplitter.h"
+
+namespace MBRP_DSP
+{
+    SpectralBandSplitter::SpectralBandSplitter(int fftOrder)
+        : fftSize(1 << fftOrder), hopSize((1 << fftOrder) / overlap), numBins((1 << fftOrder) / 2 + 1), fft(fftOrder)
+    {
+        // sqrt-Hann на анализе и синтезе: в сумме Hann, при шаге fftSize / 4 сумма окон = 2
+        window.resize((size_t)fftSize);
+        for (int n = 0; n < fftSize; ++n)
+            window[(size_t)n] = std::sqrt(0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float)n / (float)fftSize));
+
+        for (auto& channelGains : bandGains)
+            channelGains.fill(1.0f);
+    }
+
+    void SpectralBandSplitter::prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        jassert(spec.numChannels == (juce::uint32)numChannels);
+        sampleRate = spec.sampleRate;
+
+        frame.assign((size_t)(2 * fftSize), 0.0f);
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            inputFifo[(size_t)ch].assign((size_t)fftSize, 0.0f);
+            outputAccumulator[(size_t)ch].assign((size_t)fftSize, 0.0f);
+            binGains[(size_t)ch].assign((size_t)numBins, 1.0f);
+        }
+        gainSteps.assign((size_t)numBins + 1, 0.0f);
+
+        gainsDirty = true;
+        reset();
+    }
+
+    void SpectralBandSplitter::reset()
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            std::fill(inputFifo[(size_t)ch].begin(), inputFifo[(size_t)ch].end(), 0.0f);
+            std::fill(outputAccumulator[(size_t)ch].begin(), outputAccumulator[(size_t)ch].end(), 0.0f);
+        }
+        writeIndex = 0;
+        hopFill = 0;
+    }
+
+    void SpectralBandSplitter::setBandEdges(const float* edgesHz, int newNumBands) noexcept
+    {
+        jassert(newNumBands >= 1 && newNumBands <= maxBands);
+
+        if (newNumBands == numBands && std::equal(edgesHz, edgesHz + newNumBands - 1, edges.begin()))
+            return;
+
+        numBands = newNumBands;
+        std::copy(edgesHz, edgesHz + newNumBands - 1, edges.begin());
+        gainsDirty = true;
+    }
+
+    void SpectralBandSplitter::setBandGains(int band, float leftGain, float rightGain) noexcept
+    {
+        jassert(band >= 0 && band < maxBands);
+        auto& l = bandGains[0][(size_t)band];
+        auto& r = bandGains[1][(size_t)band];
+
+        if (l == leftGain && r == rightGain)
+            return;
+
+        l = leftGain;
+        r = rightGain;
+        gainsDirty = true;
+    }
+
+    void SpectralBandSplitter::updateBinGains() noexcept
+    {
+        // Маска полосы b = S(b - 1) - S(b), где S(e) - доля бина выше границы e (0..1).
+        // Тогда гейн бина G = g(0) + sum_e S(e) * (g(e + 1) - g(e)): внутри перехода
+        // слагаемое считается по бинам, выше перехода - один скачок в gainSteps.
+        // Переходы соседних границ не перекрываются, поэтому маски неотрицательны.
+        const float binHz = (float)(sampleRate / (double)fftSize);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto& g = bandGains[(size_t)ch];
+            auto& gains = binGains[(size_t)ch];
+            std::fill(gains.begin(), gains.end(), g[0]);
+            std::fill(gainSteps.begin(), gainSteps.end(), 0.0f);
+
+            for (int e = 0; e < numBands - 1; ++e)
+            {
+                const float edge = juce::jmax(binHz, edges[(size_t)e]);
+                float width = maxEdgeWidthOctaves;
+                if (e > 0)
+                    width = juce::jmin(width, 0.5f * std::log2(edge / juce::jmax(binHz, edges[(size_t)e - 1])));
+                if (e < numBands - 2)
+                    width = juce::jmin(width, 0.5f * std::log2(juce::jmax(binHz, edges[(size_t)e + 1]) / edge));
+
+                const float delta = g[(size_t)e + 1] - g[(size_t)e];
+                const float lowHz = edge * std::exp2(-width);
+                const float highHz = edge * std::exp2(width);
+                const int firstBin = juce::jlimit(1, numBins, (int)std::ceil(lowHz / binHz));
+                const int endBin = juce::jlimit(firstBin, numBins, (int)std::ceil(highHz / binHz));
+
+                for (int k = firstBin; k < endBin; ++k)
+                {
+                    const float t = width > 0.0f ? 0.5f * (std::log2((float)k * binHz / edge) / width + 1.0f) : 1.0f;
+                    gains[(size_t)k] += delta * (0.5f - 0.5f * std::cos(juce::MathConstants<float>::pi * juce::jlimit(0.0f, 1.0f, t)));
+                }
+                gainSteps[(size_t)endBin] += delta;
+            }
+
+            float step = 0.0f;
+            for (int k = 0; k < numBins; ++k)
+            {
+                step += gainSteps[(size_t)k];
+                gains[(size_t)k] += step;
+            }
+        }
+
+        gainsDirty = false;
+    }
+
+    void SpectralBandSplitter::process(float* const* channels, int numSamples) noexcept
+    {
+        // Шаг делит fftSize, поэтому кусок до конца шага не пересекает конец кольца
+        for (int pos = 0; pos < numSamples;)
+        {
+            const int count = juce::jmin(numSamples - pos, hopSize - hopFill);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* samples = channels[ch] + pos;
+                auto* fifo = inputFifo[(size_t)ch].data() + writeIndex;
+                auto* accumulator = outputAccumulator[(size_t)ch].data() + writeIndex;
+
+                juce::FloatVectorOperations::copy(fifo, samples, count);
+                juce::FloatVectorOperations::copy(samples, accumulator, count);
+                juce::FloatVectorOperations::clear(accumulator, count);
+            }
+
+            writeIndex = (writeIndex + count) % fftSize;
+            hopFill += count;
+            pos += count;
+
+            if (hopFill == hopSize)
+            {
+                processFrame();
+                hopFill = 0;
+            }
+        }
+    }
+
+    void SpectralBandSplitter::processFrame() noexcept
+    {
+        if (gainsDirty)
+            updateBinGains();
+
+        // Самый старый отсчет кадра лежит в writeIndex; выход кадра ложится в накопитель
+        // с той же позиции и читается через fftSize отсчетов
+        const float olaScale = 1.0f / (0.5f * (float)overlap);
+        const int tail = fftSize - writeIndex;
+        auto* data = frame.data();
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* fifo = inputFifo[(size_t)ch].data();
+            std::copy(fifo + writeIndex, fifo + fftSize, data);
+            std::copy(fifo, fifo + writeIndex, data + tail);
+            juce::FloatVectorOperations::multiply(data, window.data(), fftSize);
+
+            fft.performRealOnlyForwardTransform(data);
+
+            // Полный спектр: бины выше Найквиста - зеркало, гейн тот же
+            const auto* gains = binGains[(size_t)ch].data();
+            for (int k = 0; k < fftSize; ++k)
+            {
+                const float g = gains[k < numBins ? k : fftSize - k];
+                data[2 * k] *= g;
+                data[2 * k + 1] *= g;
+            }
+
+            fft.performRealOnlyInverseTransform(data);
+
+            juce::FloatVectorOperations::multiply(data, window.data(), fftSize);
+            auto* accumulator = outputAccumulator[(size_t)ch].data();
+            juce::FloatVectorOperations::addWithMultiply(accumulator + writeIndex, data, olaScale, tail);
+            juce::FloatVectorOperations::addWithMultiply(accumulator, data + tail, olaScale, writeIndex);
+        }
+    }
+}
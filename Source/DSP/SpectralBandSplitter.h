@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Спектральное деление на полосы (до 32) для режима с большим числом узких полос.
+    // STFT с перекрытием: окно sqrt-Hann на анализе и синтезе, шаг fftSize / overlap,
+    // juce::dsp::FFT того же порядка, что у анализатора спектра.
+    //
+    // Полоса - маска бинов с плавными краями: переход приподнятым косинусом
+    // в логарифмической шкале частот, маски соседних полос в сумме дают 1.
+    // Гейн и панорама полос применяются прямо в спектре: маски сворачиваются
+    // в один гейн на бин для L и для R, поэтому цена кадра (два прямых и два обратных FFT)
+    // от числа полос не зависит. Гейны на бин пересчитываются только после изменений.
+    //
+    // Задержка - fftSize отсчетов (см. getLatencySamples()).
+    class SpectralBandSplitter
+    {
+    public:
+        static constexpr int maxBands = 32;
+        static constexpr int numChannels = 2;
+        static constexpr int overlap = 4;
+        static constexpr float maxEdgeWidthOctaves = 1.0f / 6.0f; // Половина ширины перехода маски
+
+        explicit SpectralBandSplitter(int fftOrder);
+
+        void prepare(const juce::dsp::ProcessSpec& spec);
+        void reset();
+
+        // Границы полос по возрастанию, numBands - 1 значений в Гц. Применяются со следующего кадра.
+        void setBandEdges(const float* edgesHz, int numBands) noexcept;
+
+        // Гейны полосы на L и R (гейн x закон панорамы); 0 - полоса заглушена
+        void setBandGains(int band, float leftGain, float rightGain) noexcept;
+
+        // In-place, L/R
+        void process(float* const* channels, int numSamples) noexcept;
+
+        int getLatencySamples() const noexcept { return fftSize; }
+        int getNumBands() const noexcept { return numBands; }
+
+    private:
+        const int fftSize;
+        const int hopSize;
+        const int numBins; // fftSize / 2 + 1
+        juce::dsp::FFT fft;
+
+        std::vector<float> window; // sqrt-Hann (периодическое), анализ и синтез
+        std::vector<float> frame;  // 2 * fftSize: рабочий буфер FFT
+        std::array<std::vector<float>, numChannels> inputFifo, outputAccumulator, binGains;
+        std::vector<float> gainSteps; // Скачки гейна выше переходов (префиксная сумма)
+        int writeIndex = 0;           // Общий для FIFO входа и накопителя выхода
+        int hopFill = 0;
+
+        int numBands = 1;
+        std::array<float, maxBands - 1> edges{};
+        std::array<std::array<float, maxBands>, numChannels> bandGains{};
+        bool gainsDirty = true;
+        double sampleRate = 44100.0;
+
+        void processFrame() noexcept;
+        void updateBinGains() noexcept;
+    };
+}
@@ -0,0 +1,123 @@
+#include "StereoMatrixMixer.h"
+
+namespace MBRP_DSP
+{
+    namespace
+    {
+        template <int NumInputs, bool Accumulate>
+        void mixConstant(const StereoMatrixMixer::Input* inputs, float* JUCE_RESTRICT outLeft,
+                         float* JUCE_RESTRICT outRight, int numSamples) noexcept
+        {
+            const float* inL[NumInputs];
+            const float* inR[NumInputs];
+            StereoMatrix m[NumInputs];
+            for (int b = 0; b < NumInputs; ++b)
+            {
+                inL[b] = inputs[b].left;
+                inR[b] = inputs[b].right;
+                m[b] = inputs[b].start;
+            }
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                float l = Accumulate ? outLeft[i] : 0.0f;
+                float r = Accumulate ? outRight[i] : 0.0f;
+
+                for (int b = 0; b < NumInputs; ++b)
+                {
+                    const float xL = inL[b][i];
+                    const float xR = inR[b][i];
+                    l += m[b].ll * xL + m[b].rl * xR;
+                    r += m[b].lr * xL + m[b].rr * xR;
+                }
+
+                outLeft[i] = l;
+                outRight[i] = r;
+            }
+        }
+
+        template <int NumInputs, bool Accumulate>
+        void mixRamping(const StereoMatrixMixer::Input* inputs, float* JUCE_RESTRICT outLeft,
+                        float* JUCE_RESTRICT outRight, int numSamples) noexcept
+        {
+            const float* inL[NumInputs];
+            const float* inR[NumInputs];
+            StereoMatrix m[NumInputs], step[NumInputs];
+            const float invN = 1.0f / (float)numSamples;
+            for (int b = 0; b < NumInputs; ++b)
+            {
+                inL[b] = inputs[b].left;
+                inR[b] = inputs[b].right;
+                const auto& s = inputs[b].start;
+                const auto& e = inputs[b].end;
+                m[b] = s;
+                step[b] = { (e.ll - s.ll) * invN, (e.rl - s.rl) * invN, (e.lr - s.lr) * invN, (e.rr - s.rr) * invN };
+            }
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                // Замкнутая форма без зависимости между отсчетами
+                const float t = (float)(i + 1);
+                float l = Accumulate ? outLeft[i] : 0.0f;
+                float r = Accumulate ? outRight[i] : 0.0f;
+
+                for (int b = 0; b < NumInputs; ++b)
+                {
+                    const float xL = inL[b][i];
+                    const float xR = inR[b][i];
+                    l += (m[b].ll + step[b].ll * t) * xL + (m[b].rl + step[b].rl * t) * xR;
+                    r += (m[b].lr + step[b].lr * t) * xL + (m[b].rr + step[b].rr * t) * xR;
+                }
+
+                outLeft[i] = l;
+                outRight[i] = r;
+            }
+        }
+
+        template <bool Accumulate>
+        void dispatch(const StereoMatrixMixer::Input* inputs, int numInputs, bool ramping,
+                      float* outLeft, float* outRight, int numSamples) noexcept
+        {
+            using Kernel = void (*)(const StereoMatrixMixer::Input*, float*, float*, int) noexcept;
+            static constexpr Kernel constantKernels[] = { mixConstant<1, Accumulate>, mixConstant<2, Accumulate>,
+                                                          mixConstant<3, Accumulate>, mixConstant<4, Accumulate>,
+                                                          mixConstant<5, Accumulate>, mixConstant<6, Accumulate>,
+                                                          mixConstant<7, Accumulate>, mixConstant<8, Accumulate> };
+            static constexpr Kernel rampingKernels[] = { mixRamping<1, Accumulate>, mixRamping<2, Accumulate>,
+                                                         mixRamping<3, Accumulate>, mixRamping<4, Accumulate>,
+                                                         mixRamping<5, Accumulate>, mixRamping<6, Accumulate>,
+                                                         mixRamping<7, Accumulate>, mixRamping<8, Accumulate> };
+            static_assert(std::size(constantKernels) == (size_t)StereoMatrixMixer::maxInputs, "Ядро на каждое число входов");
+
+            (ramping ? rampingKernels : constantKernels)[numInputs - 1](inputs, outLeft, outRight, numSamples);
+        }
+    }
+
+    void StereoMatrixMixer::process(const Input* inputs, int numInputs, float* outLeft, float* outRight,
+                                    int numSamples, bool accumulate) noexcept
+    {
+        jassert(numInputs >= 0 && numInputs <= maxInputs);
+
+        if (numSamples <= 0)
+            return;
+
+        if (numInputs == 0)
+        {
+            if (!accumulate)
+            {
+                juce::FloatVectorOperations::clear(outLeft, numSamples);
+                juce::FloatVectorOperations::clear(outRight, numSamples);
+            }
+            return;
+        }
+
+        bool ramping = false;
+        for (int b = 0; b < numInputs; ++b)
+            ramping = ramping || inputs[b].start != inputs[b].end;
+
+        if (accumulate)
+            dispatch<true>(inputs, numInputs, ramping, outLeft, outRight, numSamples);
+        else
+            dispatch<false>(inputs, numInputs, ramping, outLeft, outRight, numSamples);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace MBRP_DSP
+{
+    // Матрица 2x2 стерео-входа: outL = ll * inL + rl * inR, outR = lr * inL + rr * inR.
+    // Гейн полосы и закон панорамы дают диагональную матрицу (rl = lr = 0).
+    struct StereoMatrix
+    {
+        float ll = 1.0f, rl = 0.0f, lr = 0.0f, rr = 1.0f;
+
+        static StereoMatrix diagonal(float left, float right) noexcept { return { left, 0.0f, 0.0f, right }; }
+        bool operator==(const StereoMatrix& o) const noexcept { return ll == o.ll && rl == o.rl && lr == o.lr && rr == o.rr; }
+        bool operator!=(const StereoMatrix& o) const noexcept { return !(*this == o); }
+    };
+
+    //==============================================================================
+    // Сведение нескольких стерео-входов через их матрицы в один стерео-выход за один проход.
+    // Матрица каждого входа линейно идет от start к end внутри блока
+    // (значение на отсчете i - start + (end - start) * (i + 1) / numSamples, как у ParameterRamp),
+    // поэтому гейны по отсчетам не нужно раскладывать в буферы.
+    //
+    // Ядро инстанцируется для каждого числа входов (1..maxInputs): внутренний цикл по входам
+    // разворачивается компилятором, а цикл по отсчетам векторизуется.
+    class StereoMatrixMixer
+    {
+    public:
+        static constexpr int maxInputs = 8;
+
+        struct Input
+        {
+            const float* left = nullptr;
+            const float* right = nullptr;
+            StereoMatrix start, end;
+        };
+
+        // accumulate == false: выход перезаписывается (очищать заранее не нужно,
+        // при numInputs == 0 выход обнуляется). Выход не должен совпадать со входами.
+        static void process(const Input* inputs, int numInputs, float* outLeft, float* outRight,
+                            int numSamples, bool accumulate) noexcept;
+    };
+}
@@ -0,0 +1,120 @@
+#include "TreeCrossover.h"
+
+namespace MBRP_DSP
+{
+    // Процессор собирает только TreeCrossover<4>; размеры для многополосных раскладок
+    // (3 и 4 уровня дерева, несколько регистров на уровень) инстанцируются явно.
+    template class TreeCrossover<8>;
+    template class TreeCrossover<16>;
+
+#if JUCE_UNIT_TESTS
+    //==============================================================================
+    // Импульс через дерево блоками, затем ДПФ суммы полос на частотах 20 Гц..20 кГц:
+    // сумма должна быть всепропускающей (0 дБ), каналы L/R - независимы, а на
+    // средней частоте своей полосы должна преобладать именно эта полоса
+    // (проверка восстановления порядка полос из бит-реверса).
+    class TreeCrossoverTests : public juce::UnitTest
+    {
+    public:
+        TreeCrossoverTests() : juce::UnitTest("TreeCrossover", "MBRP") {}
+
+        void runTest() override
+        {
+            runFlatnessTest<4>();
+            runFlatnessTest<8>();
+            runFlatnessTest<16>();
+        }
+
+    private:
+        static constexpr double sampleRate = 48000.0;
+        static constexpr int blockSize = 512;
+        static constexpr int length = 1 << 16; // Хвост AP на нижнем разделе (~30 Гц) успевает затухнуть
+
+        // Модуль ДПФ сигнала на частоте frequency, в дБ
+        static double magnitudeDb(const std::vector<float>& signal, double frequency)
+        {
+            const double w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+            double re = 0.0, im = 0.0;
+            for (size_t i = 0; i < signal.size(); ++i)
+            {
+                re += signal[i] * std::cos(w * (double)i);
+                im -= signal[i] * std::sin(w * (double)i);
+            }
+            return 20.0 * std::log10(std::max(1.0e-12, std::sqrt(re * re + im * im)));
+        }
+
+        template <int NumBands>
+        void runFlatnessTest()
+        {
+            beginTest("Band sum is flat, " + juce::String(NumBands) + " bands");
+
+            auto crossover = std::make_unique<TreeCrossover<NumBands>>(); // Частоты по умолчанию: 20 Гц..20 кГц
+            crossover->prepare({ sampleRate, (juce::uint32)blockSize, 2 });
+
+            constexpr float rightScale = 0.5f;
+            juce::AudioBuffer<float> input(2, length);
+            input.clear();
+            input.getWritePointer(0)[0] = 1.0f;
+            input.getWritePointer(1)[0] = rightScale;
+
+            std::vector<juce::AudioBuffer<float>> bandBuffers((size_t)NumBands);
+            for (auto& buffer : bandBuffers)
+                buffer.setSize(2, length);
+
+            for (int start = 0; start < length; start += blockSize)
+            {
+                const float* in[2] = { input.getReadPointer(0, start), input.getReadPointer(1, start) };
+                std::array<std::array<float*, 2>, NumBands> channels;
+                std::array<float* const*, NumBands> bands;
+                for (int b = 0; b < NumBands; ++b)
+                {
+                    channels[(size_t)b] = { bandBuffers[(size_t)b].getWritePointer(0, start),
+                                            bandBuffers[(size_t)b].getWritePointer(1, start) };
+                    bands[(size_t)b] = channels[(size_t)b].data();
+                }
+                crossover->processStereo(in, bands, blockSize);
+            }
+
+            std::vector<float> sumLeft((size_t)length, 0.0f), sumRight((size_t)length, 0.0f);
+            for (auto& buffer : bandBuffers)
+            {
+                juce::FloatVectorOperations::add(sumLeft.data(), buffer.getReadPointer(0), length);
+                juce::FloatVectorOperations::add(sumRight.data(), buffer.getReadPointer(1), length);
+            }
+
+            double maxDeviationDb = 0.0, maxChannelErrorDb = 0.0;
+            for (double f = 20.0; f <= 20000.0; f *= std::pow(2.0, 1.0 / 3.0))
+            {
+                const double left = magnitudeDb(sumLeft, f);
+                const double right = magnitudeDb(sumRight, f) - 20.0 * std::log10((double)rightScale);
+                maxDeviationDb = std::max(maxDeviationDb, std::abs(left));
+                maxChannelErrorDb = std::max(maxChannelErrorDb, std::abs(right - left));
+            }
+            expectLessThan(maxDeviationDb, 0.05);
+            expectLessThan(maxChannelErrorDb, 0.01);
+
+            // Средняя (в октавах) частота полосы b: между соседними разделами по умолчанию
+            for (int b = 0; b < NumBands; ++b)
+            {
+                const double center = 20.0 * std::pow(1000.0, ((double)b + 0.5) / (double)NumBands);
+                std::vector<float> bandLeft(bandBuffers[(size_t)b].getReadPointer(0),
+                                            bandBuffers[(size_t)b].getReadPointer(0) + length);
+                const double own = magnitudeDb(bandLeft, center);
+
+                bool dominates = true;
+                for (int other = 0; other < NumBands; ++other)
+                {
+                    if (other == b)
+                        continue;
+                    std::vector<float> otherLeft(bandBuffers[(size_t)other].getReadPointer(0),
+                                                 bandBuffers[(size_t)other].getReadPointer(0) + length);
+                    dominates = dominates && magnitudeDb(otherLeft, center) < own;
+                }
+                expect(dominates, "Band " + juce::String(b) + " is not dominant at its centre frequency");
+            }
+        }
+    };
+
+    static TreeCrossoverTests treeCrossoverTests;
+#endif
+}
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "CrossoverEngine.h"
+
+namespace MBRP_DSP
+{
+    //==============================================================================
+    // Кроссовер-дерево для большого числа полос (NumBands - степень двойки, 2..16).
+    // Каждый узел делит свою часть спектра одним LR4 (LP и HP из одних состояний,
+    // как LinkwitzRileyFilter::processSample с двумя выходами), поэтому отсчет полосы
+    // проходит log2(N) разделений вместо N - 1 фильтров каскада.
+    //
+    // Фазовая компенсация: LP + HP разделения = всепропускающий фильтр 2-го порядка (AP)
+    // на его частоте. Ветка узла проходит AP всех разделений соседнего поддерева,
+    // поэтому сумма полос = произведение AP всех частот (плоская АЧХ, как у каскада LR4).
+    // Компенсация ставится сразу после разделения и общая для всех полос ветки.
+    //
+    // Уровень дерева считается по блоку целиком: узлы уровня и каналы L/R - линии
+    // SIMD-регистров, соседние ветки идут параллельно. Выход уровня k раскладывается
+    // как "все LP, затем все HP" (без перестановок линий), поэтому ветки на последнем
+    // уровне идут в порядке бит-реверса номера полосы; порядок восстанавливается при записи.
+    //
+    // Частоты должны быть упорядочены по возрастанию. Смена частот - как у CrossoverEngine:
+    // коэффициенты линейно интерполируются к цели внутри следующего блока.
+    template <int NumBands>
+    class TreeCrossover
+    {
+    public:
+        using Vec = juce::dsp::SIMDRegister<float>;
+
+        static constexpr int numBands = NumBands;
+        static constexpr int numSplits = NumBands - 1;
+        static constexpr int numChannels = 2;
+
+        static_assert(NumBands >= 2 && NumBands <= 16 && (NumBands & (NumBands - 1)) == 0, "Степень двойки, 2..16 полос");
+        static_assert(Vec::SIMDNumElements == 4, "Раскладка линий рассчитана на 4 x float");
+
+        TreeCrossover()
+        {
+            for (int i = 0; i < numSplits; ++i)
+                cutoffs[(size_t)i] = 20.0f * std::pow(1000.0f, (float)(i + 1) / (float)NumBands); // 20 Гц..20 кГц
+            buildLaneMaps();
+        }
+
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            jassert(spec.sampleRate > 0.0);
+            jassert(spec.numChannels <= (juce::uint32)numChannels);
+
+            sampleRate = spec.sampleRate;
+            maxBlockSize = (int)spec.maximumBlockSize;
+            for (auto& buffer : scratch)
+                buffer.assign((size_t)(maxVecs * maxBlockSize), Vec::expand(0.0f));
+
+            updateCoefficients();
+            reset();
+        }
+
+        // Очищает состояние фильтров и завершает незаконченное скольжение коэффициентов
+        void reset()
+        {
+            for (auto& level : splitStates)
+                for (auto& s : level)
+                    s = {};
+            for (auto& level : compensationStates)
+                for (auto& stage : level)
+                    for (auto& s : stage)
+                        s = {};
+
+            coeffs = targetCoeffs;
+        }
+
+        void setCrossoverFrequencies(const std::array<float, numSplits>& newCutoffs)
+        {
+            if (cutoffs == newCutoffs)
+                return;
+
+            cutoffs = newCutoffs;
+            updateCoefficients();
+        }
+
+        // input - L/R, bands[b] - L/R буферы полосы b (не должны совпадать со входом).
+        // numSamples не больше spec.maximumBlockSize.
+        void processStereo(const float* const* input, const std::array<float* const*, NumBands>& bands,
+                           int numSamples) noexcept
+        {
+            jassert(numSamples <= maxBlockSize);
+            if (numSamples <= 0)
+                return;
+
+            const float invN = 1.0f / (float)numSamples;
+            const bool gliding = isGliding();
+
+            for (int level = 0; level < numLevels; ++level)
+            {
+                const Vec* src = scratch[(size_t)((level + 1) % 2)].data();
+                Vec* dst = scratch[(size_t)(level % 2)].data();
+
+                if (gliding)
+                    processLevel<true>(level, input, src, dst, numSamples, invN);
+                else
+                    processLevel<false>(level, input, src, dst, numSamples, invN);
+            }
+
+            // Линии последнего уровня -> буферы полос (бит-реверс позиции = номер полосы)
+            const Vec* result = scratch[(size_t)((numLevels - 1) % 2)].data();
+            alignas(16) float tmp[4];
+            for (int v = 0; v < maxVecs; ++v)
+            {
+                float* dest[4];
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    const int l = v * 4 + lane;
+                    dest[lane] = bands[(size_t)bandOfPosition(l / 2)][l % 2];
+                }
+
+                const Vec* in = result + v * maxBlockSize;
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    in[i].copyToRawArray(tmp);
+                    dest[0][i] = tmp[0];
+                    dest[1][i] = tmp[1];
+                    dest[2][i] = tmp[2];
+                    dest[3][i] = tmp[3];
+                }
+            }
+
+            snapStatesToZero();
+            coeffs = targetCoeffs;
+        }
+
+    private:
+        static constexpr int levelsFor(int n) { return n <= 1 ? 0 : 1 + levelsFor(n / 2); }
+
+        static constexpr int numLevels = levelsFor(NumBands);
+        static constexpr int maxVecs = NumBands / 2;      // Выход последнего уровня: N полос x 2 канала
+        static constexpr int maxLanes = maxVecs * 4;
+        static constexpr int maxStages = NumBands / 2 - 1; // AP компенсации после корня
+
+        // Уровень k: на входе inVecs(k) регистров (узлы x L/R), на выходе outVecs(k) = 2^k.
+        // Вход корня - { L, R, L, R }: линии 0-1 дают LP, линии 2-3 - HP.
+        static constexpr int outVecs(int level) { return 1 << level; }
+        static constexpr int inVecs(int level) { return level == 0 ? 1 : outVecs(level - 1); }
+        static constexpr int numStages(int level) { return NumBands / (2 << level) - 1; }
+
+        struct SplitState { Vec s1, s2, s3, s4; };
+        struct AllPassState { Vec s1, s2; };
+
+        std::array<float, numSplits> cutoffs{};
+        std::array<LR4LowpassCoeffs, numSplits> coeffs;       // на начало блока
+        std::array<LR4LowpassCoeffs, numSplits> targetCoeffs; // на конец блока
+
+        // Номер разделения для каждой линии: входы уровня и ступени компенсации на его выходе
+        std::array<std::array<int, maxLanes>, numLevels> splitOfLane{};
+        std::array<std::array<std::array<int, maxLanes>, juce::jmax(1, maxStages)>, numLevels> stageSplitOfLane{};
+
+        std::array<std::array<SplitState, maxVecs>, numLevels> splitStates;
+        std::array<std::array<std::array<AllPassState, maxVecs>, juce::jmax(1, maxStages)>, numLevels> compensationStates;
+
+        std::array<std::vector<Vec>, 2> scratch; // [регистр][отсчет], уровни пишут по очереди
+        double sampleRate = 44100.0;
+        int maxBlockSize = 0;
+
+        // Часть спектра [first, last) узла уровня level в позиции position.
+        // Бит i позиции - выбор ветки на уровне i (0 - LP, 1 - HP).
+        static void getNodeRange(int level, int position, int& first, int& last) noexcept
+        {
+            first = 0;
+            last = NumBands;
+            for (int i = 0; i < level; ++i)
+            {
+                const int mid = (first + last) / 2;
+                if ((position >> i) & 1)
+                    first = mid;
+                else
+                    last = mid;
+            }
+        }
+
+        static int bandOfPosition(int position) noexcept
+        {
+            int first, last;
+            getNodeRange(numLevels, position, first, last);
+            return first;
+        }
+
+        void buildLaneMaps()
+        {
+            for (int level = 0; level < numLevels; ++level)
+            {
+                // Вход уровня: узел - позиция линии / 2 (у корня все линии - один узел)
+                for (int l = 0; l < inVecs(level) * 4; ++l)
+                {
+                    int first, last;
+                    getNodeRange(level, level == 0 ? 0 : l / 2, first, last);
+                    splitOfLane[(size_t)level][(size_t)l] = (first + last) / 2 - 1;
+                }
+
+                // Выход уровня: ветка получает AP разделений соседнего поддерева
+                for (int l = 0; l < outVecs(level) * 4; ++l)
+                {
+                    const int position = l / 2;
+                    int first, last;
+                    getNodeRange(level, position & ((1 << level) - 1), first, last);
+                    const int mid = (first + last) / 2;
+                    const bool isHigh = ((position >> level) & 1) != 0;
+                    const int siblingFirst = isHigh ? first : mid;
+
+                    for (int stage = 0; stage < numStages(level); ++stage)
+                        stageSplitOfLane[(size_t)level][(size_t)stage][(size_t)l] = siblingFirst + stage;
+                }
+            }
+        }
+
+        void updateCoefficients()
+        {
+            for (int i = 0; i < numSplits; ++i)
+                targetCoeffs[(size_t)i].setCutoff(cutoffs[(size_t)i], sampleRate);
+        }
+
+        bool isGliding() const noexcept
+        {
+            for (int i = 0; i < numSplits; ++i)
+                if (coeffs[(size_t)i].g != targetCoeffs[(size_t)i].g)
+                    return true;
+
+            return false;
+        }
+
+        // Коэффициенты линий регистра: g, h на начало блока и шаги к цели
+        struct LaneCoeffs { Vec g, k, h, dg, dh; };
+
+        LaneCoeffs getLaneCoeffs(const int* splitIndices, float invN) const noexcept
+        {
+            alignas(16) float g[4], h[4], k[4], dg[4], dh[4];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                const auto& c = coeffs[(size_t)splitIndices[lane]];
+                const auto& t = targetCoeffs[(size_t)splitIndices[lane]];
+                g[lane] = c.g;
+                h[lane] = c.h;
+                k[lane] = c.R2 + c.g;
+                dg[lane] = (t.g - c.g) * invN;
+                dh[lane] = (t.h - c.h) * invN;
+            }
+            return { Vec::fromRawArray(g), Vec::fromRawArray(k), Vec::fromRawArray(h),
+                     Vec::fromRawArray(dg), Vec::fromRawArray(dh) };
+        }
+
+        template <bool Gliding>
+        void processLevel(int level, const float* const* input, const Vec* src, Vec* dst,
+                          int numSamples, float invN) noexcept
+        {
+            const Vec R2 = Vec::expand(std::sqrt(2.0f));
+            const int numIn = inVecs(level);
+
+            // 1. Разделение: LP и HP каждого узла из одних состояний
+            for (int v = 0; v < numIn; ++v)
+            {
+                auto c = getLaneCoeffs(splitOfLane[(size_t)level].data() + v * 4, invN);
+                auto& st = splitStates[(size_t)level][(size_t)v];
+                Vec s1 = st.s1, s2 = st.s2, s3 = st.s3, s4 = st.s4;
+
+                auto split = [&](Vec x, Vec& low, Vec& high)
+                {
+                    if constexpr (Gliding)
+                    {
+                        c.g += c.dg; c.k += c.dg; c.h += c.dh;
+                    }
+
+                    auto yH = (x - c.k * s1 - s2) * c.h;
+                    auto yB = c.g * yH + s1;
+                    s1 = c.g * yH + yB;
+                    auto yL = c.g * yB + s2;
+                    s2 = c.g * yB + yL;
+
+                    auto yH2 = (yL - c.k * s3 - s4) * c.h;
+                    auto yB2 = c.g * yH2 + s3;
+                    s3 = c.g * yH2 + yB2;
+                    auto yL2 = c.g * yB2 + s4;
+                    s4 = c.g * yB2 + yL2;
+
+                    low = yL2;
+                    high = yL - R2 * yB + yH - yL2;
+                };
+
+                if (level == 0)
+                {
+                    // { L, R, L, R } -> { LP L, LP R, HP L, HP R }
+                    alignas(16) const float lowMask[4] = { 1.0f, 1.0f, 0.0f, 0.0f };
+                    alignas(16) const float highMask[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+                    const Vec maskLow = Vec::fromRawArray(lowMask), maskHigh = Vec::fromRawArray(highMask);
+                    alignas(16) float x[4];
+
+                    for (int i = 0; i < numSamples; ++i)
+                    {
+                        x[0] = x[2] = input[0][i];
+                        x[1] = x[3] = input[1][i];
+                        Vec low, high;
+                        split(Vec::fromRawArray(x), low, high);
+                        dst[i] = low * maskLow + high * maskHigh;
+                    }
+                }
+                else
+                {
+                    const Vec* in = src + v * maxBlockSize;
+                    Vec* low = dst + v * maxBlockSize;
+                    Vec* high = dst + (numIn + v) * maxBlockSize;
+                    for (int i = 0; i < numSamples; ++i)
+                        split(in[i], low[i], high[i]);
+                }
+
+                st = { s1, s2, s3, s4 };
+            }
+
+            // 2. Компенсация фазы: AP разделений соседнего поддерева (in-place)
+            for (int stage = 0; stage < numStages(level); ++stage)
+            {
+                for (int v = 0; v < outVecs(level); ++v)
+                {
+                    auto c = getLaneCoeffs(stageSplitOfLane[(size_t)level][(size_t)stage].data() + v * 4, invN);
+                    auto& st = compensationStates[(size_t)level][(size_t)stage][(size_t)v];
+                    Vec s1 = st.s1, s2 = st.s2;
+                    Vec* samples = dst + v * maxBlockSize;
+
+                    for (int i = 0; i < numSamples; ++i)
+                    {
+                        if constexpr (Gliding)
+                        {
+                            c.g += c.dg; c.k += c.dg; c.h += c.dh;
+                        }
+
+                        // Первый каскад LR4 в режиме allpass (LinkwitzRileyFilter::Type::allpass)
+                        auto yH = (samples[i] - c.k * s1 - s2) * c.h;
+                        auto yB = c.g * yH + s1;
+                        s1 = c.g * yH + yB;
+                        auto yL = c.g * yB + s2;
+                        s2 = c.g * yB + yL;
+                        samples[i] = yL - R2 * yB + yH;
+                    }
+
+                    st = { s1, s2 };
+                }
+            }
+        }
+
+        // Аналог util::snapToZero из JUCE для всех линий регистра
+        static void snapToZero(Vec& v) noexcept
+        {
+            alignas(16) float tmp[4];
+            v.copyToRawArray(tmp);
+            for (auto& x : tmp)
+                if (!(x < -1.0e-8f || x > 1.0e-8f))
+                    x = 0.0f;
+            v = Vec::fromRawArray(tmp);
+        }
+
+        void snapStatesToZero() noexcept
+        {
+            for (int level = 0; level < numLevels; ++level)
+            {
+                for (int v = 0; v < inVecs(level); ++v)
+                {
+                    auto& s = splitStates[(size_t)level][(size_t)v];
+                    snapToZero(s.s1); snapToZero(s.s2); snapToZero(s.s3); snapToZero(s.s4);
+                }
+
+                for (int stage = 0; stage < numStages(level); ++stage)
+                {
+                    for (int v = 0; v < outVecs(level); ++v)
+                    {
+                        auto& s = compensationStates[(size_t)level][(size_t)stage][(size_t)v];
+                        snapToZero(s.s1); snapToZero(s.s2);
+                    }
+                }
+            }
+        }
+
+        JUCE_DECLARE_NON_COPYABLE(TreeCrossover)
+    };
+}
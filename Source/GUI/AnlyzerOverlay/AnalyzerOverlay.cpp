@@ -94,6 +94,7 @@ namespace MBRP_GUI
 
     AnalyzerOverlay::~AnalyzerOverlay()
     {
+        setBandSpectrumSource(nullptr);
         for (int i = 0; i < numBands; ++i) {
             soloAttachments[i].reset();
             muteAttachments[i].reset();
@@ -106,20 +107,144 @@ namespace MBRP_GUI
         if (bandIndex >= 0 && bandIndex < numBands)
         {
             activeBandIndex = bandIndex;
+            updateBandSpectrumSources();
             repaint(); // Перерисовать, чтобы обновить подсветку
         }
     }
 
+    void AnalyzerOverlay::setBandSpectrumSource(SpectrumAnalysisThread* analysisThread)
+    {
+        if (bandSpectrumSource != nullptr)
+            for (int band = 0; band < numBands; ++band)
+                bandSpectrumSource->setSourceEnabled(SpectrumAnalysisThread::getBandSource(band), false);
+
+        bandSpectrumSource = analysisThread;
+        updateBandSpectrumSources();
+    }
+
+    void AnalyzerOverlay::setBandSpectraMode(BandSpectraMode newMode)
+    {
+        bandSpectraMode = newMode;
+        updateBandSpectrumSources();
+        repaint();
+    }
+
+    bool AnalyzerOverlay::isBandSpectrumShown(int band) const
+    {
+        return bandSpectrumSource != nullptr
+            && (bandSpectraMode == BandSpectraMode::allBands
+                || (bandSpectraMode == BandSpectraMode::activeBand && band == activeBandIndex));
+    }
+
+    void AnalyzerOverlay::updateBandSpectrumSources()
+    {
+        for (int band = 0; band < numBands; ++band)
+        {
+            const bool shown = isBandSpectrumShown(band);
+            if (bandSpectrumSource != nullptr)
+                bandSpectrumSource->setSourceEnabled(SpectrumAnalysisThread::getBandSource(band), shown);
+            if (!shown)
+                bandSpectrumPaths[(size_t)band].clear();
+        }
+    }
+
+    void AnalyzerOverlay::rebuildBandSpectrumPath(int band, const juce::Rectangle<float>& graphBounds)
+    {
+        auto& path = bandSpectrumPaths[(size_t)band];
+        path.clear();
+
+        const auto& frame = bandSpectrumSource->getFrame(SpectrumAnalysisThread::getBandSource(band));
+        const double sampleRate = processorRef.getSampleRate();
+        const int numBins = frame.fftSize / 2;
+        if (sampleRate <= 0.0 || numBins <= 0 || graphBounds.isEmpty())
+            return;
+
+        const float binWidthHz = (float)(sampleRate / ((double)frame.decimation * (double)frame.fftSize));
+        const float left = graphBounds.getX(), width = graphBounds.getWidth();
+        const float top = graphBounds.getY(), height = graphBounds.getHeight();
+        const float bottom = graphBounds.getBottom();
+        const float mindB = SpectrumAnalysisThread::mindB;
+
+        // Бины одного пикселя по X сводятся к максимуму; прореженная полоса кончается на своей Найквисту
+        int column = -1;
+        float columnDb = mindB, lastX = left;
+        auto addPoint = [&](float x, float db)
+        {
+            if (path.isEmpty()) // Контур начинается от нижнего края
+                path.startNewSubPath(x, bottom);
+            path.lineTo(x, mapGainDbToY(db, top, height, mindB, spectrumMaxDb));
+            lastX = x;
+        };
+
+        for (int bin = 1; bin < numBins; ++bin)
+        {
+            const float freq = (float)bin * binWidthHz;
+            if (freq < minLogFreq)
+                continue;
+            if (freq > maxLogFreq)
+                break;
+
+            const float x = mapFreqToXLog(freq, left, width, minLogFreq, maxLogFreq);
+            const int binColumn = (int)x;
+            if (binColumn != column)
+            {
+                if (column >= 0)
+                    addPoint((float)column, columnDb);
+                column = binColumn;
+                columnDb = mindB;
+            }
+            columnDb = std::max(columnDb, frame.spectrumDb[(size_t)bin]);
+        }
+
+        if (column >= 0)
+            addPoint((float)column, columnDb);
+        if (!path.isEmpty())
+        {
+            path.lineTo(lastX, bottom);
+            path.closeSubPath();
+        }
+    }
+
+    juce::Rectangle<int> AnalyzerOverlay::getBandSpectrumArea(int band) const
+    {
+        const auto& path = bandSpectrumPaths[(size_t)band];
+        return path.isEmpty() ? juce::Rectangle<int>() : path.getBounds().expanded(1.0f).getSmallestIntegerContainer();
+    }
+
+    void AnalyzerOverlay::drawBandSpectra(juce::Graphics& g)
+    {
+        const juce::Colour bandColours[] = {
+            ColorScheme::getLowBandColor(), ColorScheme::getLowMidBandColor(),
+            ColorScheme::getMidHighBandColor(), ColorScheme::getHighBandAltColor()
+        };
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            const auto& path = bandSpectrumPaths[(size_t)band];
+            if (path.isEmpty())
+                continue;
+
+            g.setColour(bandColours[band].withAlpha(0.18f));
+            g.fillPath(path);
+            g.setColour(bandColours[band].withAlpha(0.8f));
+            g.strokePath(path, juce::PathStrokeType(1.0f));
+        }
+    }
+
 
     // Отрисовка
     void AnalyzerOverlay::paint(juce::Graphics& g)
     {
         auto graphBounds = getGraphBounds();
-        // Рисуем подсветку активной полосы Gain ДО линий и маркеров
-        drawGainMarkersAndActiveBandHighlight(g, graphBounds);
+        drawBandSpectra(g); // Под всеми элементами управления
         drawHoverHighlight(g, graphBounds); // Подсветка для перетаскивания кроссоверов
-        drawCrossoverLines(g, graphBounds);
-        // drawGainMarkers(g, graphBounds); // Теперь это часть drawGainMarkersAndActiveBandHighlight
+
+        // Подсветка активной полосы, маркеры Gain и линии кроссоверов - готовое изображение,
+        // пересоздается только при ресайзе и смене параметров (см. timerCallback)
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (!controlsLayer.isValid() || !juce::approximatelyEqual(controlsLayerScale, scale))
+            renderControlsLayer(scale);
+        g.drawImage(controlsLayer, getLocalBounds().toFloat());
     }
 
     // Таймер для анимации (пока без изменений, он управляет подсветкой кроссоверов)
@@ -127,13 +252,34 @@ namespace MBRP_GUI
     {
         bool needsRepaint = false;
 
+        // Перерисовка по областям: спектр полосы и подсветка кроссовера - только там, где они
+        // были и стали; все компоненты - только при смене параметров слоя controlsLayer
+        juce::Rectangle<int> dirtyArea;
+
+        // Новые кадры спектров показываемых полос
+        for (int band = 0; band < numBands; ++band)
+        {
+            if (isBandSpectrumShown(band)
+                && bandSpectrumSource->acquireFrame(SpectrumAnalysisThread::getBandSource(band)))
+            {
+                dirtyArea = dirtyArea.getUnion(getBandSpectrumArea(band));
+                rebuildBandSpectrumPath(band, getGraphBounds());
+                dirtyArea = dirtyArea.getUnion(getBandSpectrumArea(band));
+            }
+        }
+
+        bool highlightChanged = false;
         if (!juce::approximatelyEqual(currentHighlightAlpha, targetHighlightAlpha)) {
             currentHighlightAlpha += (targetHighlightAlpha - currentHighlightAlpha) * alphaAnimationSpeed;
             if (std::abs(currentHighlightAlpha - targetHighlightAlpha) < 0.001f) {
                 currentHighlightAlpha = targetHighlightAlpha;
             }
-            needsRepaint = true;
+            highlightChanged = true;
         }
+        const auto newHighlightArea = getHoverHighlightArea();
+        if (highlightChanged || newHighlightArea != highlightArea)
+            dirtyArea = dirtyArea.getUnion(highlightArea).getUnion(newHighlightArea);
+        highlightArea = newHighlightArea;
 
         if (popupHideDelayFramesCounter > 0)
         {
@@ -149,15 +295,23 @@ namespace MBRP_GUI
                 }
             }
         }
-        // из-за автоматизации DAW или перетаскивания в этом же компоненте.
-        positionBandControls(getGraphBounds());
-        // Всегда перерисовываем, чтобы линии обновлялись, если параметр изменился извне
-        // Это также обновит и маркеры Gain, если их параметры изменились
-        needsRepaint = true;
+        // Кроссоверы и Gain меняются из-за автоматизации DAW или перетаскивания в этом же компоненте.
+        // Слой и кнопки полос обновляются, только когда снимок параметров отличается
+        const auto state = getControlsLayerState();
+        if (state != controlsLayerState)
+        {
+            controlsLayerState = state;
+            controlsLayer = {};
+            positionBandControls(getGraphBounds());
+            needsRepaint = true;
+        }
 
         if (needsRepaint) {
             repaint();
         }
+        else if (!dirtyArea.isEmpty()) {
+            repaint(dirtyArea);
+        }
     }
 
     // --- НОВЫЙ МЕТОД для отображения Pop-up кроссовера ---
@@ -197,6 +351,10 @@ namespace MBRP_GUI
 
     void AnalyzerOverlay::resized()
     {
+        controlsLayer = {}; // Перерисуется в следующем paint()
+        for (int band = 0; band < numBands; ++band)
+            if (isBandSpectrumShown(band))
+                rebuildBandSpectrumPath(band, getGraphBounds());
         repaint();
         positionBandControls(getGraphBounds());
     }
@@ -482,14 +640,14 @@ namespace MBRP_GUI
         }
     }
 
-    void AnalyzerOverlay::drawHoverHighlight(juce::Graphics& g, juce::Rectangle<float> graphBounds)
+    bool AnalyzerOverlay::getHoverHighlight(const juce::Rectangle<float>& graphBounds,
+                                            juce::Rectangle<float>& highlightRect, juce::Colour& highlightColour) const
     {
         // ... (Логика подсветки кроссоверов, пока без изменений) ...
         // Если будете добавлять подсветку для Gain, ее нужно будет интегрировать сюда или вызвать отдельно
-        if (currentHighlightAlpha <= 0.0f) return;
+        if (currentHighlightAlpha <= 0.0f) return false;
         using namespace juce;
         float targetX = -1.0f;
-        Colour highlightColour = Colours::transparentBlack;
         CrossoverHoverState stateToUse = CrossoverHoverState::None; // Используем состояния кроссовера
         if (currentCrossoverDragState != CrossoverDraggingState::None) {
             if (currentCrossoverDragState == CrossoverDraggingState::DraggingLowMid) stateToUse = CrossoverHoverState::HoveringLowMid;
@@ -502,7 +660,7 @@ namespace MBRP_GUI
         else {
             stateToUse = lastCrossoverHoverStateForColor;
         }
-        if (stateToUse == CrossoverHoverState::None) return;
+        if (stateToUse == CrossoverHoverState::None) return false;
         auto left = graphBounds.getX(); auto width = graphBounds.getWidth();
         auto top = graphBounds.getY(); auto bottom = graphBounds.getBottom();
         if (stateToUse == CrossoverHoverState::HoveringLowMid) {
@@ -517,17 +675,60 @@ namespace MBRP_GUI
             targetX = mapFreqToXLog(processorRef.midHighCrossover->get(), left, width, minLogFreq, maxLogFreq);
             highlightColour = ColorScheme::getMidHighCrossoverColor();
         }
-        if (targetX >= left && targetX <= graphBounds.getRight()) {
-            Rectangle<float> highlightRect;
-            highlightRect.setWidth(highlightRectWidth);
-            highlightRect.setCentre(targetX, graphBounds.getCentreY());
-            highlightRect.setY(top);
-            highlightRect.setBottom(bottom);
+        if (targetX < left || targetX > graphBounds.getRight()) return false;
+
+        highlightRect = {};
+        highlightRect.setWidth(highlightRectWidth);
+        highlightRect.setCentre(targetX, graphBounds.getCentreY());
+        highlightRect.setY(top);
+        highlightRect.setBottom(bottom);
+        return true;
+    }
+
+    void AnalyzerOverlay::drawHoverHighlight(juce::Graphics& g, juce::Rectangle<float> graphBounds)
+    {
+        juce::Rectangle<float> highlightRect;
+        juce::Colour highlightColour;
+        if (getHoverHighlight(graphBounds, highlightRect, highlightColour)) {
             g.setColour(highlightColour.withAlpha(currentHighlightAlpha));
             g.fillRect(highlightRect);
         }
     }
 
+    juce::Rectangle<int> AnalyzerOverlay::getHoverHighlightArea() const
+    {
+        juce::Rectangle<float> highlightRect;
+        juce::Colour highlightColour;
+        return getHoverHighlight(getGraphBounds(), highlightRect, highlightColour)
+            ? highlightRect.getSmallestIntegerContainer() : juce::Rectangle<int>();
+    }
+
+    AnalyzerOverlay::ControlsLayerState AnalyzerOverlay::getControlsLayerState() const
+    {
+        ControlsLayerState state;
+        state.crossovers = { processorRef.lowMidCrossover->get(), processorRef.midCrossover->get(), processorRef.midHighCrossover->get() };
+        for (size_t band = 0; band < (size_t)numBands; ++band)
+            state.gains[band] = processorRef.gainParams[band]->load();
+        state.activeBand = activeBandIndex;
+        state.activePan = processorRef.panParams[(size_t)activeBandIndex]->load(); // Наклон градиента активной полосы
+        return state;
+    }
+
+    void AnalyzerOverlay::renderControlsLayer(float scale)
+    {
+        using namespace juce;
+        const int imageWidth = jmax(1, roundToInt((float)getWidth() * scale));
+        const int imageHeight = jmax(1, roundToInt((float)getHeight() * scale));
+        controlsLayer = Image(Image::ARGB, imageWidth, imageHeight, true);
+        controlsLayerScale = scale;
+
+        Graphics g(controlsLayer);
+        g.addTransform(AffineTransform::scale(scale));
+        auto graphBounds = getGraphBounds();
+        drawGainMarkersAndActiveBandHighlight(g, graphBounds);
+        drawCrossoverLines(g, graphBounds);
+    }
+
     std::pair<AnalyzerOverlay::GainDraggingState, juce::AudioParameterFloat*> AnalyzerOverlay::getGainInfoAt(const juce::MouseEvent& event, const juce::Rectangle<float>& graphBounds)
     {
         float mouseX = static_cast<float>(event.x);
@@ -4,6 +4,7 @@
 #include <functional> 
 #include "../Source/GUI/LookAndFeel.h" 
 #include "../Source/PluginProcessor.h" 
+#include "../Source/GUI/SpectrumAnalyzer/SpectrumAnalysisThread.h"
 
 namespace MBRP_GUI
 {
@@ -57,13 +58,24 @@ namespace MBRP_GUI
 
         std::function<void(int bandIndex)> onBandAreaClicked;
         void setActiveBand(int bandIndex);
+
+        // Спектры полос (отводы после кроссовера) цветом полосы поверх общего спектра.
+        // Источник - поток анализа SpectrumAnalyzer; отводы неотображаемых полос выключаются.
+        enum class BandSpectraMode { off, activeBand, allBands };
+        void setBandSpectrumSource(SpectrumAnalysisThread* analysisThread);
+        void setBandSpectraMode(BandSpectraMode newMode);
+        BandSpectraMode getBandSpectraMode() const { return bandSpectraMode; }
     private:
         // Объявление метода класса
         
 
         void drawCrossoverLines(juce::Graphics& g, juce::Rectangle<float> graphBounds);
         void drawHoverHighlight(juce::Graphics& g, juce::Rectangle<float> graphBounds);
+        bool getHoverHighlight(const juce::Rectangle<float>& graphBounds,
+                               juce::Rectangle<float>& highlightRect, juce::Colour& highlightColour) const;
+        juce::Rectangle<int> getHoverHighlightArea() const;
         void drawGainMarkersAndActiveBandHighlight(juce::Graphics& g, juce::Rectangle<float> graphBounds);
+        void drawBandSpectra(juce::Graphics& g);
 
         void positionBandControls(const juce::Rectangle<float>& graphBounds);
 
@@ -119,6 +131,41 @@ namespace MBRP_GUI
         juce::TextButton muteButtons[numBands];
         juce::TextButton bypassButtons[numBands]; // Если решите добавить и Bypass сюда
 
+        // --- Спектры полос ---
+        static constexpr float spectrumMaxDb = 36.0f; // Шкала SpectrumAnalyzer (снизу - SpectrumAnalysisThread::mindB)
+        SpectrumAnalysisThread* bandSpectrumSource{ nullptr };
+        BandSpectraMode bandSpectraMode{ BandSpectraMode::activeBand };
+        std::array<juce::Path, numBands> bandSpectrumPaths; // Замкнутый контур спектра в координатах компонента
+
+        bool isBandSpectrumShown(int band) const;
+        void updateBandSpectrumSources();   // Включает в потоке анализа только показываемые полосы
+        void rebuildBandSpectrumPath(int band, const juce::Rectangle<float>& graphBounds);
+        juce::Rectangle<int> getBandSpectrumArea(int band) const;
+
+        // --- Кэш слоя: подсветка активной полосы, маркеры Gain, линии кроссоверов ---
+        // Снимок параметров, от которых зависит слой; таймер сравнивает его с текущими
+        struct ControlsLayerState
+        {
+            std::array<float, 3> crossovers{};
+            std::array<float, numBands> gains{};
+            float activePan = 0.0f;
+            int activeBand = -1;
+
+            bool operator== (const ControlsLayerState& other) const
+            {
+                return crossovers == other.crossovers && gains == other.gains
+                    && activePan == other.activePan && activeBand == other.activeBand;
+            }
+            bool operator!= (const ControlsLayerState& other) const { return !(*this == other); }
+        };
+        ControlsLayerState controlsLayerState;
+        juce::Image controlsLayer;
+        float controlsLayerScale = 1.0f;
+        juce::Rectangle<int> highlightArea; // Последняя нарисованная подсветка кроссовера
+
+        ControlsLayerState getControlsLayerState() const;
+        void renderControlsLayer(float scale);
+
         using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
         std::unique_ptr<ButtonAttachment> soloAttachments[numBands];
         std::unique_ptr<ButtonAttachment> muteAttachments[numBands];
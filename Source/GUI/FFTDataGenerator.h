@@ -5,13 +5,7 @@
 
 namespace MBRP_GUI
 {
-    // Перечисление для порядков FFT
-    enum FFTOrder
-    {
-        order2048 = 11,
-        order4096 = 12,
-        order8192 = 13
-    };
+    // FFTOrder - в Utilities.h (общий с анализатором)
 
     // Класс, отвечающий за выполнение FFT и подготовку данных для рендеринга
     template<typename BlockType> // BlockType здесь std::vector<float>
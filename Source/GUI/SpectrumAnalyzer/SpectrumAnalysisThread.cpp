@@ -0,0 +1,230 @@
+#include "SpectrumAnalysisThread.h"
+#include <algorithm>
+
+namespace MBRP_GUI
+{
+    SpectrumAnalysisThread::Stream::Stream(MBRP_DSP::CaptureRing& captureRing, const MBRP_DSP::DecimatingCapture* bandTap) :
+        ring{ captureRing },
+        tap{ bandTap },
+        history((size_t)maxFFTSize, 0.0f)
+    {
+        using Vec = juce::dsp::SIMDRegister<float>;
+        static_assert(maxNumBins % Vec::SIMDNumElements == 0, "peakHoldLevels идет сразу за displayData и тоже выровнен");
+
+        binStorage.allocate((size_t)(2 * maxNumBins) + Vec::SIMDNumElements, false);
+        displayData = Vec::getNextSIMDAlignedPtr(binStorage.get());
+        peakHoldLevels = displayData + maxNumBins;
+        std::fill_n(displayData, maxNumBins, mindB);
+        std::fill_n(peakHoldLevels, maxNumBins, mindB);
+        avgSpectrumData.clear();
+
+        // Вся память кадров выделяется здесь, публикация только копирует
+        frames.forEach([](Frame& frame)
+        {
+            frame.spectrumDb.assign((size_t)maxNumBins, mindB);
+            frame.peakDb.assign((size_t)maxNumBins, mindB);
+            frame.peakLevelDb = mindB;
+        });
+    }
+
+    SpectrumAnalysisThread::SpectrumAnalysisThread(MBRPAudioProcessor& p) :
+        juce::Thread("MBRP Spectrum Analysis"),
+        processor{ p },
+        captureLeft((size_t)captureBlockSize, 0.0f),
+        captureRight((size_t)captureBlockSize, 0.0f),
+        fftBuffer((size_t)maxFFTSize * 2, 0.0f),
+        peakDecayDb(SpectrumKernels::getPeakDecayDb(peakHoldDecayFactor))
+    {
+        streams[(size_t)Source::output] = std::make_unique<Stream>(processor.outputCapture, nullptr);
+        streams[(size_t)Source::input] = std::make_unique<Stream>(processor.inputCapture, nullptr);
+        for (int band = 0; band < MBRPAudioProcessor::numBands; ++band)
+        {
+            auto& tap = processor.bandCaptures[(size_t)band];
+            streams[(size_t)getBandSource(band)] = std::make_unique<Stream>(tap.getRing(), &tap);
+        }
+        getStream(Source::output).enabled.store(true);
+
+        startThread(juce::Thread::Priority::low);
+    }
+
+    SpectrumAnalysisThread::~SpectrumAnalysisThread()
+    {
+        stopThread(1000);
+    }
+
+    void SpectrumAnalysisThread::run()
+    {
+        while (!threadShouldExit())
+        {
+            // Новый размер: публикуются кадры со сброшенным спектром и новым fftSize
+            const bool planChanged = applyRequestedSettings();
+            const bool isActive = active.load();
+
+            for (auto& s : streams)
+            {
+                auto& stream = *s;
+                const bool streamActive = isActive && stream.enabled.load();
+                bool changed = planChanged;
+
+                if (streamActive)
+                {
+                    if (readNewSamples(stream))
+                    {
+                        updateDisplayData(stream);
+                        changed = true;
+                    }
+                    changed = decayPeaks(stream) || changed;
+                }
+                else if (stream.wasActive)
+                {
+                    clearState(stream);
+                    changed = true;
+                }
+                stream.wasActive = streamActive;
+
+                if (changed)
+                    publishFrame(stream);
+            }
+
+            wait(updateIntervalMs);
+        }
+    }
+
+    bool SpectrumAnalysisThread::applyRequestedSettings()
+    {
+        const int order = juce::jlimit((int)FFTOrder::order2048, maxFFTOrder, requestedOrder.load());
+        const bool planChanged = plan == nullptr || plan->order != order;
+        if (planChanged)
+        {
+            // План и окно строятся здесь, а не в потоке сообщений; история входа общая
+            // для всех размеров, поэтому первый кадр нового размера считается сразу
+            plan = std::make_unique<Plan>(order);
+            for (auto& stream : streams)
+            {
+                stream->avgSpectrumData.clear();
+                stream->avgSpectrumDataPtr = 1;
+                clearState(*stream);
+            }
+            hopSize = 0;
+        }
+
+        const int hop = plan->size >> juce::jlimit(1, 3, requestedOverlap.load());
+        if (hop != hopSize)
+        {
+            hopSize = hop;
+            for (auto& stream : streams)
+            {
+                const int pending = stream->samplesUntilNextFrame;
+                stream->samplesUntilNextFrame = juce::jlimit(1, hopSize, pending > 0 ? pending : hopSize);
+            }
+        }
+        return planChanged;
+    }
+
+    bool SpectrumAnalysisThread::readNewSamples(Stream& stream)
+    {
+        bool frameWasAnalysed = false;
+        auto* left = captureLeft.data();
+        auto* right = captureRight.data();
+
+        while (const int count = stream.ring.pull(left, right, captureBlockSize))
+        {
+            switch (channel.load())
+            {
+                case Channel::left:  break;
+                case Channel::right: juce::FloatVectorOperations::copy(left, right, count); break;
+                case Channel::mid:   juce::FloatVectorOperations::add(left, right, count); break;
+                case Channel::side:  juce::FloatVectorOperations::subtract(left, right, count); break;
+            }
+
+            frameWasAnalysed = pushToHistory(stream, left, count) || frameWasAnalysed;
+        }
+
+        return frameWasAnalysed;
+    }
+
+    bool SpectrumAnalysisThread::pushToHistory(Stream& stream, const float* samples, int numSamples)
+    {
+        bool frameWasAnalysed = false;
+        int offset = 0;
+        while (offset < numSamples)
+        {
+            // В историю - не дальше следующей границы шага
+            const int chunk = std::min(numSamples - offset, stream.samplesUntilNextFrame);
+            const int first = std::min(chunk, maxFFTSize - stream.historyWritePos);
+            std::copy(samples + offset, samples + offset + first, stream.history.begin() + stream.historyWritePos);
+            std::copy(samples + offset + first, samples + offset + chunk, stream.history.begin());
+            stream.historyWritePos = (stream.historyWritePos + chunk) % maxFFTSize;
+
+            offset += chunk;
+            stream.samplesUntilNextFrame -= chunk;
+            if (stream.samplesUntilNextFrame == 0)
+            {
+                analyseFrame(stream);
+                stream.samplesUntilNextFrame = hopSize;
+                frameWasAnalysed = true;
+            }
+        }
+        return frameWasAnalysed;
+    }
+
+    void SpectrumAnalysisThread::analyseFrame(Stream& stream)
+    {
+        const int size = plan->size;
+        const int numBins = getNumBins();
+        float* buffer = fftBuffer.data();
+
+        // Последние size отсчетов истории, от старых к новым
+        const int start = (stream.historyWritePos - size + maxFFTSize) % maxFFTSize;
+        const int first = std::min(size, maxFFTSize - start);
+        std::copy(stream.history.begin() + start, stream.history.begin() + start + first, buffer);
+        std::copy(stream.history.begin(), stream.history.begin() + (size - first), buffer + first);
+        std::fill(buffer + size, buffer + 2 * size, 0.0f);
+
+        plan->window.multiplyWithWindowingTable(buffer, (size_t)size);
+        plan->fft.performFrequencyOnlyForwardTransform(buffer);
+
+        // Скользящее среднее по кадрам: из суммы (канал 0) вычитается самый старый кадр,
+        // на его место пишется новый и добавляется к сумме. Магнитуды приводятся
+        // к уровню FFT 2048, чтобы смена размера не сдвигала спектр по уровню.
+        const float normFactor = (float)referenceFFTSize / ((float)size * (float)numAveragingFrames);
+        stream.avgSpectrumData.addFrom(0, 0, stream.avgSpectrumData.getReadPointer(stream.avgSpectrumDataPtr), numBins, -1.0f);
+        stream.avgSpectrumData.copyFrom(stream.avgSpectrumDataPtr, 0, buffer, numBins, normFactor);
+        stream.avgSpectrumData.addFrom(0, 0, stream.avgSpectrumData.getReadPointer(stream.avgSpectrumDataPtr), numBins);
+
+        if (++stream.avgSpectrumDataPtr >= stream.avgSpectrumData.getNumChannels())
+            stream.avgSpectrumDataPtr = 1;
+    }
+
+    void SpectrumAnalysisThread::updateDisplayData(Stream& stream)
+    {
+        stream.peakDbLevel = SpectrumKernels::processFrame(stream.avgSpectrumData.getReadPointer(0), juce::Decibels::decibelsToGain(gainAdjustment),
+                                                           stream.displayData, stream.peakHoldLevels, getNumBins(),
+                                                           smoothingAlpha, peakDecayDb, mindB);
+    }
+
+    bool SpectrumAnalysisThread::decayPeaks(Stream& stream)
+    {
+        return SpectrumKernels::decayPeaks(stream.displayData, stream.peakHoldLevels, getNumBins(),
+                                           peakDecayDb, mindB);
+    }
+
+    void SpectrumAnalysisThread::clearState(Stream& stream)
+    {
+        std::fill_n(stream.displayData, maxNumBins, mindB);
+        std::fill_n(stream.peakHoldLevels, maxNumBins, mindB);
+        stream.peakDbLevel = mindB;
+    }
+
+    void SpectrumAnalysisThread::publishFrame(Stream& stream)
+    {
+        const int numBins = getNumBins();
+        auto& frame = stream.frames.getWriteBuffer();
+        std::copy(stream.displayData, stream.displayData + numBins, frame.spectrumDb.begin());
+        std::copy(stream.peakHoldLevels, stream.peakHoldLevels + numBins, frame.peakDb.begin());
+        frame.peakLevelDb = stream.peakDbLevel;
+        frame.fftSize = plan->size;
+        frame.decimation = stream.tap != nullptr ? stream.tap->getFactor() : 1;
+        stream.frames.publish();
+    }
+}
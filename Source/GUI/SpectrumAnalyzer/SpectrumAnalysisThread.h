@@ -0,0 +1,202 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "../Source/PluginProcessor.h" // Для FIFO выхода процессора
+#include "../Source/GUI/Utilities.h"   // Для FFTOrder
+#include "SpectrumKernels.h"
+
+namespace MBRP_GUI
+{
+    //==============================================================================
+    // Тройной буфер: писатель и читатель никогда не ждут друг друга.
+    // Писатель заполняет getWriteBuffer() и публикует его, читатель забирает последний
+    // опубликованный кадр через acquire(); промежуточные кадры просто перезаписываются.
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        T& getWriteBuffer() noexcept { return buffers[(size_t)back]; }
+        const T& getReadBuffer() const noexcept { return buffers[(size_t)front]; }
+
+        // Поток писателя
+        void publish() noexcept
+        {
+            back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+        }
+
+        // Поток читателя: true - в getReadBuffer() новый кадр
+        bool acquire() noexcept
+        {
+            if ((middle.load(std::memory_order_acquire) & freshBit) == 0)
+                return false;
+
+            front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+            return true;
+        }
+
+        template <typename Function>
+        void forEach(Function&& f) { for (auto& b : buffers) f(b); }
+
+    private:
+        static constexpr int freshBit = 4;
+        static constexpr int indexMask = 3;
+
+        std::array<T, 3> buffers;
+        int back = 0, front = 1;
+        std::atomic<int> middle{ 2 };
+    };
+
+    //==============================================================================
+    // Фоновый поток анализатора: забирает стерео из захватов процессора (выход, вход,
+    // отводы полос), сводит в выбранный канал (L, R, M, S) в историю источника и считает
+    // STFT с перекрытием - кадр FFT каждые hop = fftSize / 2, / 4 или / 8 отсчетов,
+    // окно Ханна по последним fftSize отсчетам. Дальше усреднение, перевод в dB,
+    // сглаживание и удержание пиков; готовый кадр публикуется для отрисовки, поток
+    // сообщений только забирает его (acquireFrame()/getFrame()).
+    //
+    // Размер FFT и перекрытие меняются на ходу: setFFTOrder()/setOverlap() только
+    // запоминают запрос, план FFT и окно строит этот поток и сразу переходит на них.
+    // Каждый кадр несет свой fftSize, поэтому отрисовка переключается вместе с данными.
+    //
+    // План общий для всех источников. Отводы нижних полос прорежены, их кадры несут
+    // decimation: при том же fftSize разрешение по частоте у них выше, а кадров меньше.
+    // Источник читается, только пока включен (setSourceEnabled()); невыключенный
+    // захват без читателя сам останавливается в аудиопотоке.
+    class SpectrumAnalysisThread : public juce::Thread
+    {
+    public:
+        static constexpr float mindB = -100.0f; // Нижняя граница кадра
+        static constexpr int maxFFTOrder = FFTOrder::order8192;
+        static constexpr int maxFFTSize = 1 << maxFFTOrder;
+        static constexpr int maxNumBins = maxFFTSize / 2;
+        static constexpr int updateIntervalMs = 16; // ~60 кадров в секунду
+
+        enum class Overlap { half = 1, threeQuarters = 2, sevenEighths = 3 }; // hop = fftSize >> value
+        enum class Channel { left, right, mid, side }; // mid = L + R (уровень прежнего моно-захвата), side = L - R
+
+        // Полосы идут подряд с firstBand, в порядке индексов полос процессора
+        enum class Source { output, input, lowBand, lowMidBand, midHighBand, highBand };
+        static constexpr int numSources = 6;
+        static constexpr int firstBand = (int)Source::lowBand;
+        static Source getBandSource(int band) noexcept { return (Source)(firstBand + band); }
+
+        struct Frame
+        {
+            std::vector<float> spectrumDb; // Сглаженный спектр, первые fftSize / 2 значений
+            std::vector<float> peakDb;     // Удержание пиков
+            float peakLevelDb = mindB;     // Общий пик кадра
+            int fftSize = 1 << FFTOrder::order2048;
+            int decimation = 1;            // Бин k - частота k * sampleRate / (decimation * fftSize)
+        };
+
+        explicit SpectrumAnalysisThread(MBRPAudioProcessor& p);
+        ~SpectrumAnalysisThread() override;
+
+        // Выключенный анализатор не читает захваты (те сами останавливаются); публикуются пустые кадры
+        void setActive(bool shouldBeActive) noexcept { active.store(shouldBeActive); }
+
+        // Источники, кроме выхода, по умолчанию выключены
+        void setSourceEnabled(Source source, bool shouldBeEnabled) noexcept { getStream(source).enabled.store(shouldBeEnabled); }
+        bool isSourceEnabled(Source source) const noexcept { return getStream(source).enabled.load(); }
+
+        // Любой поток; применяется фоновым потоком перед следующим кадром
+        void setFFTOrder(FFTOrder newOrder) noexcept { requestedOrder.store((int)newOrder); }
+        void setOverlap(Overlap newOverlap) noexcept { requestedOverlap.store((int)newOverlap); }
+        void setChannel(Channel newChannel) noexcept { channel.store(newChannel); }
+        FFTOrder getFFTOrder() const noexcept { return (FFTOrder)requestedOrder.load(); }
+        Overlap getOverlap() const noexcept { return (Overlap)requestedOverlap.load(); }
+
+        // Поток сообщений; у каждого источника один читатель
+        bool acquireFrame(Source source = Source::output) noexcept { return getStream(source).frames.acquire(); }
+        const Frame& getFrame(Source source = Source::output) const noexcept { return getStream(source).frames.getReadBuffer(); }
+
+        void run() override;
+
+    private:
+        static constexpr float gainAdjustment = -40.0f; // Подстройка уровня выходного сигнала (для FFT 2048)
+        static constexpr int referenceFFTSize = 1 << FFTOrder::order2048;
+        static constexpr float smoothingAlpha = 0.2f;
+        static constexpr float peakHoldDecayFactor = 0.957f; // Затухание пиков за кадр
+        static constexpr int numAveragingFrames = 4;
+
+        // План FFT и окно одного размера; строится и используется только этим потоком
+        struct Plan
+        {
+            explicit Plan(int newOrder)
+                : order(newOrder), size(1 << newOrder), fft(newOrder),
+                  window((size_t)size, juce::dsp::WindowingFunction<float>::hann)
+            {
+            }
+
+            int order;
+            int size;
+            juce::dsp::FFT fft;
+            juce::dsp::WindowingFunction<float> window;
+        };
+
+        // Захват и состояние анализа одного источника (кроме enabled и frames - только этот поток)
+        struct Stream
+        {
+            Stream(MBRP_DSP::CaptureRing& captureRing, const MBRP_DSP::DecimatingCapture* bandTap);
+
+            MBRP_DSP::CaptureRing& ring;
+            const MBRP_DSP::DecimatingCapture* tap; // nullptr - без прореживания
+            std::atomic<bool> enabled{ false };
+            bool wasActive = false;
+
+            // История входа (кольцо на maxFFTSize) и отсчеты до следующего кадра STFT
+            std::vector<float> history;
+            int historyWritePos = 0;
+            int samplesUntilNextFrame = 0;
+
+            juce::AudioBuffer<float> avgSpectrumData{ numAveragingFrames + 1, maxNumBins }; // Канал 0 - сумма, 1..N - кадры
+            int avgSpectrumDataPtr = 1;
+
+            // По maxNumBins значений, выровнены под SIMDRegister (SpectrumKernels читает их выровненной загрузкой)
+            juce::HeapBlock<float> binStorage;
+            float* displayData = nullptr;
+            float* peakHoldLevels = nullptr;
+            float peakDbLevel = mindB;
+
+            TripleBuffer<Frame> frames;
+        };
+
+        MBRPAudioProcessor& processor;
+        std::atomic<bool> active{ true };
+        std::atomic<int> requestedOrder{ FFTOrder::order2048 };
+        std::atomic<int> requestedOverlap{ (int)Overlap::threeQuarters };
+        std::atomic<Channel> channel{ Channel::mid };
+
+        std::unique_ptr<Plan> plan;
+        int hopSize = 0;
+
+        // Порция из захвата и рабочий буфер FFT - общие для всех источников
+        static constexpr int captureBlockSize = 2048;
+        std::vector<float> captureLeft, captureRight;
+        std::vector<float> fftBuffer;
+
+        const float peakDecayDb; // peakHoldDecayFactor в dB за кадр
+
+        std::array<std::unique_ptr<Stream>, numSources> streams;
+
+        Stream& getStream(Source source) noexcept { return *streams[(size_t)source]; }
+        const Stream& getStream(Source source) const noexcept { return *streams[(size_t)source]; }
+
+        bool applyRequestedSettings();                 // Новый план / шаг, если запрошены; true - сменился размер
+        bool readNewSamples(Stream& stream);           // true - посчитан хотя бы один кадр STFT
+        bool pushToHistory(Stream& stream, const float* samples, int numSamples);
+        void analyseFrame(Stream& stream);             // Окно, FFT и скользящее среднее по последним fftSize отсчетам
+        void updateDisplayData(Stream& stream);        // Усредненные магнитуды -> dB, сглаживание, пики (SpectrumKernels)
+        bool decayPeaks(Stream& stream);               // Затухание пиков между кадрами; true - что-то изменилось
+        void clearState(Stream& stream);
+        void publishFrame(Stream& stream);
+
+        int getNumBins() const noexcept { return plan->size / 2; }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalysisThread)
+    };
+}
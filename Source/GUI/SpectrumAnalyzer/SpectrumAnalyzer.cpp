@@ -19,26 +19,22 @@ namespace MBRP_GUI
 
     SpectrumAnalyzer::SpectrumAnalyzer(MBRPAudioProcessor& p) :
         processor{ p },
-        displayData(size_t(MBRPAudioProcessor::fftSize / 2), mindB),
-        peakHoldLevels(size_t(MBRPAudioProcessor::fftSize / 2), mindB),
         fftPoints(MBRPAudioProcessor::fftSize)
     {
-        peakDbLevel.store(mindB);
-        avgSpectrumData.clear(); // Используем avgSpectrumData (бывший avgInput)        
+        setOpaque(true); // Фон закрывает весь компонент: родитель под ним не перерисовывается
         startTimerHz(60);
     }
 
     void SpectrumAnalyzer::timerCallback()
     {
-        bool newDataAvailableForProcessing = false; // Локальный флаг для этого вызова
+        // Кадр уже посчитан фоновым потоком, здесь только забираем его
+        bool needsRepaint = analysis.acquireFrame();
 
-        if (processor.nextFFTBlockReady.load()) // Проверяем общий флаг из процессора
+        // Сменился размер FFT - бины по X пересчитываются сразу, без ожидания ресайза
+        if (needsRepaint && analysis.getFrame().fftSize != displayedFftSize)
         {
-            // Проверяем, есть ли данные именно в ВЫХОДНОМ FIFO
-            if (processor.abstractFifoOutput.getNumReady() >= MBRPAudioProcessor::fftSize) {
-                drawNextFrame(); // Эта функция сама сбросит nextFFTBlockReady, если обработает данные
-                newDataAvailableForProcessing = processor.nextFFTBlockReady.load() == false; // true, если drawNextFrame обработал и сбросил
-            }
+            displayedFftSize = analysis.getFrame().fftSize;
+            recalculateFftPoints();
         }
 
         if (resizeDebounceInFrames > 0)
@@ -47,163 +43,19 @@ namespace MBRP_GUI
             if (resizeDebounceInFrames == 0)
             {
                 recalculateFftPoints();
-                // Если не было новых данных для ОБРАБОТКИ в этом вызове, но был ресайз, 
-                // перерисовываем с текущими displayData
-                if (!newDataAvailableForProcessing) {
-                    repaint();
-                }
+                lastWidthForFftPointsRecalc = getWidth();
+                needsRepaint = true;
             }
-            // Не выходим здесь, чтобы пики могли обновиться
         }
 
-        bool peakNeedsRepaint = false;
-        if (analyzerIsActive.load()) { // Обновляем пики только если активен
-            for (size_t i = 0; i < peakHoldLevels.size(); ++i)
-            {
-                float oldPeakDb = peakHoldLevels[i];
-                if (oldPeakDb > displayData[i] && oldPeakDb > mindB + 0.01f)
-                {
-                    peakHoldLevels[i] = std::max(displayData[i], juce::Decibels::gainToDecibels(juce::Decibels::decibelsToGain(oldPeakDb) * peakHoldDecayFactor, mindB));
-                    if (!juce::approximatelyEqual(peakHoldLevels[i], oldPeakDb)) {
-                        peakNeedsRepaint = true;
-                    }
-                }
-                else if (displayData[i] > oldPeakDb) { // Если текущий уровень спектра выше пика
-                    peakHoldLevels[i] = displayData[i];
-                    if (!juce::approximatelyEqual(peakHoldLevels[i], oldPeakDb)) {
-                        peakNeedsRepaint = true;
-                    }
-                }
-            }
-        }
-
-
-        // Перерисовываем, если были обработаны новые данные ИЛИ если пики требуют обновления
-        if (newDataAvailableForProcessing || peakNeedsRepaint) {
-            repaint();
-        }
-    }
-
-    void SpectrumAnalyzer::drawNextFrame()
-    {
-        bool dataWasProcessedInThisLoopIteration = false;
-
-        // --- Используем ВЫХОДНОЙ FIFO процессора ---
-        while (processor.abstractFifoOutput.getNumReady() >= MBRPAudioProcessor::fftSize)
+        // Перерисовывается только область, которую занимал и занимает спектр; фон - из backgroundLayer
+        if (needsRepaint && analyzerIsActive.load())
         {
-            fftBuffer.clear();
-            int start1, block1, start2, block2;
-
-            processor.abstractFifoOutput.prepareToRead(MBRPAudioProcessor::fftSize, start1, block1, start2, block2);
-
-            const int audioFifoSize = processor.audioFifoOutput.getNumSamples();
-            if (audioFifoSize > 0) { // Убедимся, что буфер FIFO не пуст (хотя getNumReady уже это проверяет)
-                if (block1 > 0) fftBuffer.copyFrom(0, 0, processor.audioFifoOutput.getReadPointer(0, start1 % audioFifoSize), block1);
-                if (block2 > 0) fftBuffer.copyFrom(0, block1, processor.audioFifoOutput.getReadPointer(0, start2 % audioFifoSize), block2);
-            }
-
-            processor.abstractFifoOutput.finishedRead(block1 + block2);
-            // --- Конец чтения из ВЫХОДНОГО FIFO ---
-
-            // Применяем окно Ханна
-            hannWindow.multiplyWithWindowingTable(fftBuffer.getWritePointer(0), static_cast<size_t>(MBRPAudioProcessor::fftSize));
-            
-            // Выполняем БПФ
-            forwardFFT.performFrequencyOnlyForwardTransform(fftBuffer.getWritePointer(0)); // Результат в fftBuffer
-
-            // Усреднение магнитуд (алгоритм как был для avgInput)
-            // avgSpectrumData - это AudioBuffer<float> { numAvgFrames, fftSize / 2 }
-            // fftBuffer - это AudioBuffer<float> { 1, fftSize * 2 }, магнитуды в первой половине
-            {
-                juce::ScopedLock lockedForAvgUpdate(pathCreationLock);
-
-                // Канал 0 в avgSpectrumData используется для хранения суммы
-                // Каналы с 1 по N-1 в avgSpectrumData - это отдельные кадры для усреднения
-                const int numAveragingFrames = avgSpectrumData.getNumChannels() - 1;
-                if (numAveragingFrames <= 0) { // Защита, если avgSpectrumData настроен некорректно
-                    jassertfalse; return;
-                }
-
-                // 1. Вычитаем старые значения (из avgSpectrumDataPtr-го канала) из суммы (0-й канал)
-                avgSpectrumData.addFrom(0, 0, avgSpectrumData.getReadPointer(avgSpectrumDataPtr), avgSpectrumData.getNumSamples(), -1.0f);
-
-                // 2. Копируем новые магнитуды (из fftBuffer) в avgSpectrumDataPtr-й канал, нормализуя
-                float normFactor = 1.0f / static_cast<float>(numAveragingFrames);
-                avgSpectrumData.copyFrom(avgSpectrumDataPtr, 0, fftBuffer.getReadPointer(0), avgSpectrumData.getNumSamples(), normFactor);
-
-                // 3. Добавляем новые нормализованные значения (из avgSpectrumDataPtr-го канала) к сумме (0-й канал)
-                avgSpectrumData.addFrom(0, 0, avgSpectrumData.getReadPointer(avgSpectrumDataPtr), avgSpectrumData.getNumSamples());
-            }
-
-            // Обновляем указатель для циклического буфера усреднения
-            if (++avgSpectrumDataPtr >= avgSpectrumData.getNumChannels())
-                avgSpectrumDataPtr = 1; // avgSpectrumDataPtr циклически проходит от 1 до N-1
-
-            dataWasProcessedInThisLoopIteration = true;
-            
-        }
-
-
-        if (dataWasProcessedInThisLoopIteration)
-        {
-            // Сбрасываем флаг готовности данных в процессоре, так как мы их обработали
-            processor.nextFFTBlockReady.store(false);
-
-            auto numBins = avgSpectrumData.getNumSamples(); // Это fftSize/2
-            std::vector<float> latestDbData(numBins); // Временный вектор для dB значений этого кадра
-
-            // Убедимся, что displayData и peakHoldLevels имеют правильный размер
-            if (displayData.size() != numBins) displayData.assign(numBins, mindB);
-            if (peakHoldLevels.size() != numBins) peakHoldLevels.assign(numBins, mindB);
-
-            const float* averagedMagnitudes = nullptr;
-            {
-                juce::ScopedLock lockedForAvgRead(pathCreationLock);
-                // Усредненные магнитуды находятся в 0-м канале avgSpectrumData
-                if (avgSpectrumData.getNumSamples() > 0)
-                    averagedMagnitudes = avgSpectrumData.getReadPointer(0);
-            }
-
-            if (averagedMagnitudes == nullptr) {
-                DBG("Averaged magnitudes are null!");
-                return;
-            }
-
-            const float gainMultiplier = juce::Decibels::decibelsToGain(gainAdjustment); // gainAdjustment = 0.0f
-
-            float currentFramePeak = mindB; // Пик для текущего обработанного кадра
-
-            for (size_t i = 0; i < numBins; ++i)
-            {
-                float finalMagnitude = averagedMagnitudes[i] * gainMultiplier; // Уже усредненная и нормализованная магнитуда
-                latestDbData[i] = juce::Decibels::gainToDecibels(finalMagnitude, mindB);
-                if (latestDbData[i] > currentFramePeak)
-                    currentFramePeak = latestDbData[i];
-            }
-            peakDbLevel.store(currentFramePeak); // Обновляем общий пик
-
-            // Применяем экспоненциальное сглаживание к displayData и обновляем peakHoldLevels
-            for (size_t i = 0; i < numBins; ++i)
-            {
-                float newValDb = latestDbData[i];       // dB значение текущего усредненного кадра
-                float oldDisplayDb = displayData[i];    // Предыдущее отображаемое значение (сглаженное)
-                float oldPeakDb = peakHoldLevels[i];    // Предыдущий пик для этого бина
-
-                // Экспоненциальное сглаживание для displayData
-                displayData[i] = smoothingAlpha * newValDb + (1.0f - smoothingAlpha) * oldDisplayDb;
-                displayData[i] = std::max(mindB, displayData[i]); // Ограничение снизу
-
-                // Обновление пиков
-                if (displayData[i] > oldPeakDb) { // Пик обновляется по СГЛАЖЕННОМУ значению (или newValDb, если так нужно)
-                    peakHoldLevels[i] = displayData[i]; // Или peakHoldLevels[i] = newValDb; для более резких пиков
-                }
-                else {
-                    // Затухание пика, но не ниже текущего отображаемого уровня
-                    peakHoldLevels[i] = std::max(displayData[i],
-                        juce::Decibels::gainToDecibels(juce::Decibels::decibelsToGain(oldPeakDb) * peakHoldDecayFactor, mindB));
-                }
-                peakHoldLevels[i] = std::max(mindB, peakHoldLevels[i]); // Ограничение пика снизу
-            }
+            const auto previousArea = spectrumArea;
+            updateSpectrumPaths(getLocalBounds().toFloat().reduced(1.f, 5.f));
+            const auto dirtyArea = previousArea.getUnion(spectrumArea);
+            if (!dirtyArea.isEmpty())
+                repaint(dirtyArea);
         }
     }
 
@@ -214,19 +66,19 @@ namespace MBRP_GUI
         const auto width = bounds.getWidth();
         if (width <= 0) { fftPointsSize = 0; return; }
         const auto sampleRate = static_cast<float> (processor.getSampleRate());
-        const auto fftSizeHalved = static_cast<int> (MBRPAudioProcessor::fftSize / 2);
+        const auto fftSizeHalved = static_cast<int> (displayedFftSize / 2);
         if (sampleRate <= 0 || fftSizeHalved <= 0) { fftPointsSize = 0; return; }
         const float minLogFreq = 20.0f; // Используем константу класса minFreq
         const float maxLogFreq = sampleRate / 2.0f;
         if (maxLogFreq <= minLogFreq) { fftPointsSize = 0; return; }
         const float logRange = std::log(maxLogFreq / minLogFreq);
-        if (fftPoints.size() != MBRPAudioProcessor::fftSize) // Убедимся, что вектор имеет достаточный размер
-            fftPoints.resize(MBRPAudioProcessor::fftSize);
+        if (fftPoints.size() != static_cast<size_t>(displayedFftSize)) // Убедимся, что вектор имеет достаточный размер
+            fftPoints.resize(static_cast<size_t>(displayedFftSize));
         fftPointsSize = 0;
         int lastX = -1;
         for (int i = 1; i < fftSizeHalved; ++i)
         {
-            const float freq = sampleRate * static_cast<float>(i) / static_cast<float>(MBRPAudioProcessor::fftSize);
+            const float freq = sampleRate * static_cast<float>(i) / static_cast<float>(displayedFftSize);
             if (freq < minLogFreq) continue; // Пропускаем частоты ниже minLogFreq
             const float logPos = std::log(freq / minLogFreq) / logRange;
             const int x = juce::roundToInt(logPos * width);
@@ -242,7 +94,7 @@ namespace MBRP_GUI
                     lastX = x;
                 }
                 else {
-                    // Это не должно происходить, если fftPoints.resize(MBRPAudioProcessor::fftSize)
+                    // Это не должно происходить, если fftPoints.resize(displayedFftSize)
                     jassertfalse; // Ошибка: пытаемся записать за пределы вектора fftPoints
                     break;
                 }
@@ -260,53 +112,67 @@ namespace MBRP_GUI
         if (isActive != analyzerIsActive.load())
         {
             analyzerIsActive.store(isActive);
-            if (!isActive) {
-                std::fill(displayData.begin(), displayData.end(), mindB);
-                std::fill(peakHoldLevels.begin(), peakHoldLevels.end(), mindB);
-                peakDbLevel.store(mindB);
-            }
+            analysis.setActive(isActive); // Выключение: поток сбросит спектр и пики и опубликует пустой кадр
+            spectrumPath.clear();
+            peakPath.clear();
+            overZeroPath.clear();
+            spectrumArea = {};
             repaint();
         }
     }
 
     void SpectrumAnalyzer::paint(juce::Graphics& g)
     {
-        // ... (paint без изменений) ...
         using namespace juce;
-        g.fillAll(ColorScheme::getAnalyzerBackgroundColor());
-        auto bounds = getLocalBounds().toFloat();
-        auto graphBounds = bounds.reduced(1.f, 5.f);
-        if ((fftPointsSize == 0 || getWidth() != lastWidthForFftPointsRecalc) && getWidth() > 0) { // Добавил lastWidthForFftPointsRecalc
-            recalculateFftPoints();
-            lastWidthForFftPointsRecalc = getWidth();
-        }
-        drawFrequencyGrid(g, graphBounds);
-        //КОММЕНТ
 
-        
-        drawGainScale(g, graphBounds); // эта строка
-        
-        if (analyzerIsActive.load())   // эта строка
+        // Фон, сетка и шкала - готовое изображение в физических пикселях; пересоздается на ресайзе
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (!backgroundLayer.isValid() || !approximatelyEqual(backgroundLayerScale, scale))
+            renderBackgroundLayer(scale);
+        g.drawImage(backgroundLayer, getLocalBounds().toFloat());
+
+        if (analyzerIsActive.load())
         {
-            drawSpectrumAndPeaks(g, graphBounds);
+            drawSpectrumAndPeaks(g);
             /*
             g.setColour(ColorScheme::getAnalyzerPeakTextColor());
             auto peakFont = juce::Font(juce::FontOptions(12.0f)); g.setFont(peakFont);
-            float currentPeak = peakDbLevel.load();
+            float currentPeak = analysis.getFrame().peakLevelDb;
             String peakText = "Peak: " + ((currentPeak <= mindB + 0.01f) ? String("-inf dB") : String(currentPeak, 1) + " dB");
             float peakTextAreaWidth = getTextLayoutWidth(peakText, peakFont) + 10.f; float peakTextAreaHeight = 15.f;
             juce::Rectangle<float> peakTextArea(graphBounds.getRight() - peakTextAreaWidth, graphBounds.getY(), peakTextAreaWidth, peakTextAreaHeight);
             g.drawText(peakText, peakTextArea.toNearestInt(), Justification::centredRight, false); */
-        } 
+        }
+
         g.setColour(ColorScheme::getAnalyzerOutlineColor());
         g.drawRect(getLocalBounds(), 1.f); 
     }
 
+    void SpectrumAnalyzer::renderBackgroundLayer(float scale)
+    {
+        using namespace juce;
+        const int imageWidth = jmax(1, roundToInt((float)getWidth() * scale));
+        const int imageHeight = jmax(1, roundToInt((float)getHeight() * scale));
+        backgroundLayer = Image(Image::RGB, imageWidth, imageHeight, false);
+        backgroundLayerScale = scale;
+
+        Graphics g(backgroundLayer);
+        g.addTransform(AffineTransform::scale(scale));
+        g.fillAll(ColorScheme::getAnalyzerBackgroundColor());
+        auto graphBounds = getLocalBounds().toFloat().reduced(1.f, 5.f);
+        drawFrequencyGrid(g, graphBounds);
+        //КОММЕНТ
+
+        
+        drawGainScale(g, graphBounds); // эта строка
+    }
+
     // Объявление lastWidthForFftPointsRecalc, если он еще не объявлен в .h
     // int SpectrumAnalyzer::lastWidthForFftPointsRecalc = 0; // Если статический член, но он не статический
 
     void SpectrumAnalyzer::resized()
     {
+        backgroundLayer = {}; // Перерисуется в следующем paint()
         static constexpr int framesToWaitBeforePaintingAfterResizing = 5;
         resizeDebounceInFrames = framesToWaitBeforePaintingAfterResizing;
         // Не вызываем recalculateFftPoints() напрямую здесь, таймер позаботится об этом через debounce.
@@ -371,15 +237,27 @@ namespace MBRP_GUI
         } */
     }
 
-    void SpectrumAnalyzer::drawSpectrumAndPeaks(juce::Graphics& g, const juce::Rectangle<float>& bounds)
+    void SpectrumAnalyzer::updateSpectrumPaths(const juce::Rectangle<float>& bounds)
     {
-        // ... (drawSpectrumAndPeaks без изменений) ...
         using namespace juce;
+        spectrumPath.clear();
+        peakPath.clear();
+        overZeroPath.clear();
+        spectrumArea = {};
+
+        if ((fftPointsSize == 0 || getWidth() != lastWidthForFftPointsRecalc) && getWidth() > 0) {
+            recalculateFftPoints();
+            lastWidthForFftPointsRecalc = getWidth();
+        }
+
         auto width = bounds.getWidth(); auto top = bounds.getY(); auto bottom = bounds.getBottom();
         auto left = bounds.getX(); auto right = bounds.getRight();
-        auto numBins = displayData.size();
+        const auto& frame = analysis.getFrame();
+        const auto& displayData = frame.spectrumDb;
+        const auto& peakHoldLevels = frame.peakDb;
+        auto numBins = static_cast<size_t>(frame.fftSize / 2);
         auto sampleRate = processor.getSampleRate();
-        if (numBins == 0 || peakHoldLevels.size() != numBins || sampleRate <= 0 || width <= 0) return;
+        if (numBins == 0 || peakHoldLevels.size() < numBins || displayData.size() < numBins || sampleRate <= 0 || width <= 0) return;
         std::vector<Point<float>> spectrumPoints;
         std::vector<Point<float>> peakPointsVec;
         spectrumPoints.reserve(fftPointsSize > 0 ? fftPointsSize + 2 : numBins); // Оптимизация размера
@@ -390,11 +268,6 @@ namespace MBRP_GUI
 
         spectrumPoints.push_back({ left, bottom });
         peakPointsVec.push_back({ left, bottom });
-        const auto spectrumFillBaseCol = ColorScheme::getSpectrumFillBaseColor();
-        const auto spectrumLineCol = ColorScheme::getSpectrumLineColor();
-        const auto peakHoldLineBaseCol = ColorScheme::getPeakHoldLineBaseColor();
-        const auto overZeroLineCol = ColorScheme::getOverZeroDbLineColor();
-
         // Используем fftPoints для отрисовки, если они рассчитаны
         if (fftPointsSize > 0) {
             for (int i = 0; i < fftPointsSize; ++i) {
@@ -428,23 +301,18 @@ namespace MBRP_GUI
         spectrumPoints.push_back({ right, bottom });
         peakPointsVec.push_back({ right, bottom });
         if (spectrumPoints.size() < 2) return;
-        Path spectrumPath;
         spectrumPath.startNewSubPath(spectrumPoints[0]);
         for (size_t i = 1; i < spectrumPoints.size(); ++i) { /* ... старая логика сглаживания ... */
             const auto& p0 = spectrumPoints[i - 1]; const auto& p1 = spectrumPoints[i];
             Point<float> cp1{ (p0.x + p1.x) * 0.5f, p0.y }; Point<float> cp2{ (p0.x + p1.x) * 0.5f, p1.y };
             spectrumPath.cubicTo(cp1, cp2, p1);
         }
-        g.setColour(spectrumFillBaseCol.withAlpha(0.2f)); g.fillPath(spectrumPath);
-        g.setColour(spectrumLineCol); g.strokePath(spectrumPath, PathStrokeType(1.5f));
         if (peakPointsVec.size() >= 2) {
-            Path peakPath; peakPath.startNewSubPath(peakPointsVec[0]);
+            peakPath.startNewSubPath(peakPointsVec[0]);
             for (size_t i = 1; i < peakPointsVec.size(); ++i) peakPath.lineTo(peakPointsVec[i]);
-            g.setColour(peakHoldLineBaseCol.withAlpha(0.7f));
-            g.strokePath(peakPath, PathStrokeType(1.0f));
         }
-        // ... (логика отрисовки overZeroPath без изменений) ...
-        Path overZeroPath; bool isCurrentlyAboveZero = false;
+        // ... (логика overZeroPath без изменений) ...
+        bool isCurrentlyAboveZero = false;
         float zeroDbY = jlimit(top, jmap(0.0f, mindB, maxdB, bottom, top), bottom);
         std::vector<Point<float>> currentSegmentPoints_oz; // Переименовал, чтобы не конфликтовать
         for (size_t i = 1; i < spectrumPoints.size() - 1; ++i)
@@ -494,8 +362,24 @@ namespace MBRP_GUI
                 overZeroPath.cubicTo(cp1, cp2, p1);
             }
         }
+
+        // Пики не ниже спектра, overZeroPath - его часть; запас на толщину линий и сглаживание
+        spectrumArea = spectrumPath.getBounds().getUnion(peakPath.getBounds()).expanded(2.0f).getSmallestIntegerContainer();
+    }
+
+    void SpectrumAnalyzer::drawSpectrumAndPeaks(juce::Graphics& g) const
+    {
+        using namespace juce;
+        if (spectrumPath.isEmpty()) return;
+
+        g.setColour(ColorScheme::getSpectrumFillBaseColor().withAlpha(0.2f)); g.fillPath(spectrumPath);
+        g.setColour(ColorScheme::getSpectrumLineColor()); g.strokePath(spectrumPath, PathStrokeType(1.5f));
+        if (!peakPath.isEmpty()) {
+            g.setColour(ColorScheme::getPeakHoldLineBaseColor().withAlpha(0.7f));
+            g.strokePath(peakPath, PathStrokeType(1.0f));
+        }
         if (!overZeroPath.isEmpty()) {
-            g.setColour(overZeroLineCol); g.strokePath(overZeroPath, juce::PathStrokeType(1.5f));
+            g.setColour(ColorScheme::getOverZeroDbLineColor()); g.strokePath(overZeroPath, juce::PathStrokeType(1.5f));
         }
     }
 
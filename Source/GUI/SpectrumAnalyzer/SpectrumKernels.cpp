@@ -0,0 +1,288 @@
+#include "SpectrumKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace MBRP_GUI
+{
+    namespace
+    {
+        using Vec = juce::dsp::SIMDRegister<float>;
+
+        constexpr float decibelsPerOctave = 6.02059991f; // 20 log10(2)
+        constexpr int chunkSize = 64;                    // Бинов за проход (промежуточные массивы в L1)
+
+        // log2(1 + t), t в [0, 1): t * (c1 + t * (c2 + t * (c3 + t * c4))), интерполяция в узлах Чебышева.
+        // |ошибка| < 3.7e-4 (0.0022 dB), в t = 0 точно 0.
+        constexpr float c1 = 1.442068f;
+        constexpr float c2 = -0.700778105f;
+        constexpr float c3 = 0.364018767f;
+        constexpr float c4 = -0.105659241f;
+
+        std::int32_t toBits(float x) noexcept
+        {
+            std::int32_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            return bits;
+        }
+
+        // x -> экспонента и t = мантисса - 1 (x = 2^e * (1 + t)). Только целые операции и
+        // преобразование int -> float, такой цикл векторизуется при любых флагах FP.
+        // Ограничение снизу - сравнением битов (для x >= 0 порядок битов совпадает с порядком чисел),
+        // так что в log2 не попадают ни ноль, ни денормали.
+        void splitLog2Arguments(const float* magnitudes, float gain, std::int32_t minBits,
+                                float* exponents, float* fractions, int numBins) noexcept
+        {
+            for (int i = 0; i < numBins; ++i)
+            {
+                std::int32_t bits = toBits(magnitudes[i] * gain);
+                bits = bits < minBits ? minBits : bits;
+                exponents[i] = (float)((bits >> 23) - 127);
+
+                const std::int32_t mantissaBits = (bits & 0x007fffff) | 0x3f800000;
+                float mantissa;
+                std::memcpy(&mantissa, &mantissaBits, sizeof(mantissa));
+                fractions[i] = mantissa - 1.0f;
+            }
+        }
+
+        Vec log2Polynomial(Vec exponent, Vec t) noexcept
+        {
+            return exponent + t * (Vec::expand(c1) + t * (Vec::expand(c2) + t * (Vec::expand(c3) + t * Vec::expand(c4))));
+        }
+    }
+
+    float SpectrumKernels::fastGainToDecibels(float gain) noexcept
+    {
+        float exponent[1], fraction[1];
+        splitLog2Arguments(&gain, 1.0f, toBits(std::numeric_limits<float>::min()), exponent, fraction, 1);
+
+        const float t = fraction[0];
+        return decibelsPerOctave * (exponent[0] + t * (c1 + t * (c2 + t * (c3 + t * c4))));
+    }
+
+    float SpectrumKernels::processFrame(const float* magnitudes, float gain, float* displayDb, float* peakDb,
+                                        int numBins, float smoothingAlpha, float peakDecayDb, float minDb) noexcept
+    {
+        constexpr int lanes = (int)Vec::SIMDNumElements;
+        jassert(numBins % lanes == 0);
+        jassert(Vec::isSIMDAligned(displayDb) && Vec::isSIMDAligned(peakDb));
+
+        const std::int32_t minBits = toBits(juce::Decibels::decibelsToGain(minDb));
+        const Vec vMinDb = Vec::expand(minDb);
+        const Vec vDbPerOctave = Vec::expand(decibelsPerOctave);
+        const Vec vAlpha = Vec::expand(smoothingAlpha);
+        const Vec vKeep = Vec::expand(1.0f - smoothingAlpha);
+        const Vec vDecay = Vec::expand(peakDecayDb);
+        Vec framePeak = vMinDb;
+
+        alignas(Vec::SIMDRegisterSize) float exponents[chunkSize], fractions[chunkSize];
+
+        for (int start = 0; start < numBins; start += chunkSize)
+        {
+            const int count = std::min(chunkSize, numBins - start);
+            splitLog2Arguments(magnitudes + start, gain, minBits, exponents, fractions, count);
+
+            for (int i = 0; i < count; i += lanes)
+            {
+                float* display = displayDb + start + i;
+                float* peak = peakDb + start + i;
+
+                const Vec db = Vec::max(vMinDb, vDbPerOctave * log2Polynomial(Vec::fromRawArray(exponents + i),
+                                                                              Vec::fromRawArray(fractions + i)));
+                framePeak = Vec::max(framePeak, db);
+
+                const Vec smoothed = Vec::max(vMinDb, vAlpha * db + vKeep * Vec::fromRawArray(display));
+                smoothed.copyToRawArray(display);
+
+                // Рост - сразу до сглаженного уровня, спад - на peakDecayDb за кадр, не ниже спектра
+                Vec::max(smoothed, Vec::max(vMinDb, Vec::fromRawArray(peak) + vDecay)).copyToRawArray(peak);
+            }
+        }
+
+        float result = minDb;
+        for (size_t lane = 0; lane < Vec::SIMDNumElements; ++lane)
+            result = std::max(result, framePeak.get(lane));
+        return result;
+    }
+
+    bool SpectrumKernels::decayPeaks(const float* displayDb, float* peakDb, int numBins,
+                                     float peakDecayDb, float minDb) noexcept
+    {
+        constexpr int lanes = (int)Vec::SIMDNumElements;
+        jassert(numBins % lanes == 0);
+        jassert(Vec::isSIMDAligned(displayDb) && Vec::isSIMDAligned(peakDb));
+
+        const Vec vMinDb = Vec::expand(minDb);
+        const Vec vDecay = Vec::expand(peakDecayDb);
+        bool changed = false;
+
+        for (int i = 0; i < numBins; i += lanes)
+        {
+            const Vec old = Vec::fromRawArray(peakDb + i);
+            const Vec peak = Vec::max(Vec::fromRawArray(displayDb + i), Vec::max(vMinDb, old + vDecay));
+            peak.copyToRawArray(peakDb + i);
+            changed = changed || peak != old;
+        }
+        return changed;
+    }
+
+#if JUCE_UNIT_TESTS
+    //==============================================================================
+    // Сверка приближения log2 с std::log10 (в double). Ошибка зависит только от мантиссы,
+    // поэтому мантиссы проверяются все (x в [1, 2)), экспоненты - с шагом по битам
+    // через весь диапазон нормальных float; отдельно - ноль, денормали и бесконечность.
+    // Последний тест - замер processFrame против прежних скалярных циклов анализатора
+    // (scalarReferenceFrame), время на кадр пишется в лог.
+    class SpectrumKernelsTests : public juce::UnitTest
+    {
+    public:
+        SpectrumKernelsTests() : juce::UnitTest("SpectrumKernels", "MBRP") {}
+
+        void runTest() override
+        {
+            constexpr double toleranceDb = 0.0025;
+            const auto referenceDb = [](float x) { return 20.0 * std::log10((double)x); };
+            const auto fromBits = [](std::uint32_t bits) { float x; std::memcpy(&x, &bits, sizeof(x)); return x; };
+            const float minNormal = std::numeric_limits<float>::min();
+            const float maxFinite = std::numeric_limits<float>::max();
+
+            beginTest("All mantissas");
+            {
+                double maxError = 0.0;
+                for (std::uint32_t bits = 0x3f800000; bits < 0x40000000; ++bits)
+                {
+                    const float x = fromBits(bits);
+                    maxError = std::max(maxError, std::abs(SpectrumKernels::fastGainToDecibels(x) - referenceDb(x)));
+                }
+                expectLessThan(maxError, toleranceDb);
+            }
+
+            beginTest("Full normal range");
+            {
+                double maxError = 0.0;
+                for (std::uint64_t bits = toBits(minNormal); bits <= (std::uint64_t)toBits(maxFinite); bits += 4099)
+                {
+                    const float x = fromBits((std::uint32_t)bits);
+                    maxError = std::max(maxError, std::abs(SpectrumKernels::fastGainToDecibels(x) - referenceDb(x)));
+                }
+                expectLessThan(maxError, toleranceDb);
+                expectWithinAbsoluteError((double)SpectrumKernels::fastGainToDecibels(maxFinite), referenceDb(maxFinite), toleranceDb);
+            }
+
+            beginTest("Zero, denormals and infinity");
+            {
+                const float floorDb = SpectrumKernels::fastGainToDecibels(minNormal);
+                expectWithinAbsoluteError((double)floorDb, referenceDb(minNormal), toleranceDb);
+
+                for (float x : { 0.0f, -0.0f, std::numeric_limits<float>::denorm_min(), fromBits(0x007fffff), -1.0f })
+                    expectEquals(SpectrumKernels::fastGainToDecibels(x), floorDb);
+
+                const float infDb = SpectrumKernels::fastGainToDecibels(std::numeric_limits<float>::infinity());
+                expect(std::isfinite(infDb) && infDb >= (float)referenceDb(maxFinite) - (float)toleranceDb);
+            }
+
+            beginTest("processFrame matches fastGainToDecibels");
+            {
+                constexpr int numBins = 64;
+                constexpr float minDb = -100.0f;
+                alignas(Vec::SIMDRegisterSize) float magnitudes[numBins], displayDb[numBins], peakDb[numBins];
+                juce::Random random(0x5eed);
+                for (int i = 0; i < numBins; ++i)
+                {
+                    magnitudes[i] = i < 4 ? fromBits((std::uint32_t)i) // 0 и денормали
+                                          : std::pow(10.0f, random.nextFloat() * 10.0f - 6.0f);
+                    displayDb[i] = peakDb[i] = minDb;
+                }
+
+                SpectrumKernels::processFrame(magnitudes, 1.0f, displayDb, peakDb, numBins, 1.0f, 0.0f, minDb);
+                for (int i = 0; i < numBins; ++i)
+                    expectWithinAbsoluteError(displayDb[i], std::max(minDb, SpectrumKernels::fastGainToDecibels(magnitudes[i])),
+                                              (float)toleranceDb); // Нижняя граница processFrame - minDb, а не FLT_MIN
+            }
+
+            beginTest("processFrame vs scalar loops (benchmark)");
+            {
+                constexpr int numBins = 4096; // FFT 8192
+                constexpr int numFrames = 2000;
+                constexpr int numRuns = 5;
+                constexpr float minDb = -100.0f, gain = 2.0f, alpha = 0.2f, decayFactor = 0.995f;
+                const float decayDb = SpectrumKernels::getPeakDecayDb(decayFactor);
+
+                // Кадры - шум со спадом 3 dB/окт., чтобы часть бинов падала ниже minDb
+                std::vector<std::vector<float>> frames(8, std::vector<float>((size_t)numBins));
+                juce::Random random(0xbe7c);
+                for (auto& frame : frames)
+                    for (int i = 0; i < numBins; ++i)
+                        frame[(size_t)i] = random.nextFloat() * 0.5f / std::sqrt((float)(i + 1)) * std::pow(10.0f, random.nextFloat() * 4.0f - 3.0f);
+
+                juce::HeapBlock<float> storage((size_t)(4 * numBins) + Vec::SIMDNumElements);
+                float* const kernelDisplay = Vec::getNextSIMDAlignedPtr(storage.get());
+                float* const kernelPeak = kernelDisplay + numBins;
+                float* const scalarDisplay = kernelPeak + numBins;
+                float* const scalarPeak = scalarDisplay + numBins;
+
+                double scalarSeconds = std::numeric_limits<double>::max(), kernelSeconds = scalarSeconds;
+                float sink = 0.0f; // Не дает выбросить результат
+                for (int run = 0; run < numRuns; ++run)
+                {
+                    std::fill_n(storage.get(), 4 * numBins + (int)Vec::SIMDNumElements, minDb);
+
+                    auto start = juce::Time::getHighResolutionTicks();
+                    for (int f = 0; f < numFrames; ++f)
+                        sink += scalarReferenceFrame(frames[(size_t)f % frames.size()].data(), gain, scalarDisplay, scalarPeak,
+                                                     numBins, alpha, decayFactor, minDb);
+                    scalarSeconds = std::min(scalarSeconds, juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+
+                    start = juce::Time::getHighResolutionTicks();
+                    for (int f = 0; f < numFrames; ++f)
+                        sink += SpectrumKernels::processFrame(frames[(size_t)f % frames.size()].data(), gain, kernelDisplay, kernelPeak,
+                                                              numBins, alpha, decayDb, minDb);
+                    kernelSeconds = std::min(kernelSeconds, juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+                }
+
+                // Сглаживание и затухание пика накапливают ошибку округления за кадры, допуск - вдвое от log2
+                double maxError = 0.0;
+                for (int i = 0; i < numBins; ++i)
+                    maxError = std::max({ maxError, (double)std::abs(kernelDisplay[i] - scalarDisplay[i]),
+                                          (double)std::abs(kernelPeak[i] - scalarPeak[i]) });
+                expectLessThan(maxError, 2.0 * toleranceDb);
+                expect(std::isfinite(sink));
+
+                logMessage("Bins: " + juce::String(numBins) + ", best of " + juce::String(numRuns) + " x " + juce::String(numFrames) + " frames");
+                logMessage("Scalar loops: " + juce::String(scalarSeconds * 1.0e6 / numFrames, 2) + " us/frame");
+                logMessage("processFrame: " + juce::String(kernelSeconds * 1.0e6 / numFrames, 2) + " us/frame");
+            }
+        }
+
+    private:
+        // Прежний SpectrumAnalysisThread::updateDisplayData: log10 на бин, затухание пика через pow и log10
+        static float scalarReferenceFrame(const float* magnitudes, float gain, float* displayDb, float* peakDb,
+                                          int numBins, float smoothingAlpha, float peakDecayFactor, float minDb)
+        {
+            float framePeak = minDb;
+            for (int i = 0; i < numBins; ++i)
+            {
+                const float db = juce::Decibels::gainToDecibels(magnitudes[i] * gain, minDb);
+                framePeak = std::max(framePeak, db);
+
+                displayDb[i] = std::max(minDb, smoothingAlpha * db + (1.0f - smoothingAlpha) * displayDb[i]);
+
+                const float oldPeakDb = peakDb[i];
+                if (displayDb[i] > oldPeakDb)
+                    peakDb[i] = displayDb[i];
+                else
+                    peakDb[i] = std::max(displayDb[i],
+                        juce::Decibels::gainToDecibels(juce::Decibels::decibelsToGain(oldPeakDb) * peakDecayFactor, minDb));
+
+                peakDb[i] = std::max(minDb, peakDb[i]);
+            }
+            return framePeak;
+        }
+    };
+
+    static SpectrumKernelsTests spectrumKernelsTests;
+#endif
+}
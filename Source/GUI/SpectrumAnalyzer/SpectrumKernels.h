@@ -0,0 +1,38 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+namespace MBRP_GUI
+{
+    //==============================================================================
+    // Покадровая обработка спектра анализатора за один проход по бинам:
+    // магнитуда * gain -> dB -> экспоненциальное сглаживание -> удержание пиков.
+    //
+    // log10 заменен приближением log2: экспонента берется из битов float, мантисса
+    // [1, 2) - полином 4-й степени (узлы Чебышева), ошибка не больше 0.0025 dB
+    // (по всем нормальным float - 0.00217 dB). Ноль, денормали и отрицательные дают
+    // dB(FLT_MIN) = -758.6 dB, бесконечность - dB(FLT_MAX) = 770.6 dB. Сверка с std::log10 и замер
+    // против прежних скалярных циклов - SpectrumKernelsTests в SpectrumKernels.cpp (при JUCE_UNIT_TESTS).
+    // Затухание пика считается прямо в dB: gainToDecibels(decibelsToGain(p) * k) = p + 20 log10(k).
+    // Разбор float на экспоненту и мантиссу - целочисленный цикл по блоку бинов,
+    // остальное - SIMDRegister по 4 бина. numBins кратно 4, displayDb/peakDb выровнены
+    // под SIMDRegister (Vec::isSIMDAligned).
+    struct SpectrumKernels
+    {
+        // dB/отсчет для затухания пика с множителем амплитуды decayFactor за кадр
+        static float getPeakDecayDb(float decayFactor) noexcept { return 20.0f * std::log10(decayFactor); }
+
+        // 20 log10(x) для x >= FLT_MIN с ошибкой < 0.0025 dB; меньшие x - как FLT_MIN
+        static float fastGainToDecibels(float gain) noexcept;
+
+        // Новый кадр: displayDb сглаживается к dB(magnitudes * gain), peakDb - max(display, peak + decayDb).
+        // Все значения не ниже minDb. Возвращает наибольший dB кадра (до сглаживания).
+        static float processFrame(const float* magnitudes, float gain, float* displayDb, float* peakDb,
+                                  int numBins, float smoothingAlpha, float peakDecayDb, float minDb) noexcept;
+
+        // Между кадрами: только затухание пиков. true - хоть один пик изменился.
+        static bool decayPeaks(const float* displayDb, float* peakDb, int numBins,
+                               float peakDecayDb, float minDb) noexcept;
+    };
+}
@@ -13,6 +13,14 @@ static constexpr float MAX_DB = 24.f;
 
 static constexpr float MIN_THRESHOLD = -60.f;
 
+// Порядки FFT анализатора
+enum FFTOrder
+{
+    order2048 = 11,
+    order4096 = 12,
+    order8192 = 13
+};
+
 
 template<
     typename Attachment,
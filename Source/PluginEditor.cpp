@@ -43,6 +43,7 @@ MBRPAudioProcessorEditor::MBRPAudioProcessorEditor(MBRPAudioProcessor& p)
     // Добавляем компоненты
     addAndMakeVisible(controlBar.analyzerButton); // Добавляем кнопку напрямую
     addAndMakeVisible(bypassButton);
+    addAndMakeVisible(processingOptionsButton);
 
     addAndMakeVisible(lowMidCrossoverSlider); addAndMakeVisible(lowMidCrossoverLabel);
     addAndMakeVisible(midCrossoverSlider);    addAndMakeVisible(midCrossoverLabel);
@@ -65,6 +66,7 @@ MBRPAudioProcessorEditor::MBRPAudioProcessorEditor(MBRPAudioProcessor& p)
 
     addAndMakeVisible(analyzer);
     addAndMakeVisible(analyzerOverlay);
+    addAndMakeVisible(analyzerResolutionButton);
 
     auto setupRotarySliderComponent =
         [&](RotarySliderWithLabels& slider, bool titleIsAbove, bool showRange)
@@ -96,6 +98,14 @@ MBRPAudioProcessorEditor::MBRPAudioProcessorEditor(MBRPAudioProcessor& p)
     bypassButton.setTooltip("Bypass the plugin processing");
     bypassButton.setClickingTogglesState(true);
 
+    processingOptionsButton.setButtonText("Options");
+    processingOptionsButton.setTooltip("Processing modes (saved with the session)");
+    processingOptionsButton.onClick = [this] { showProcessingOptionsMenu(); };
+
+    analyzerResolutionButton.setButtonText("FFT");
+    analyzerResolutionButton.setTooltip("Analyzer FFT size and overlap");
+    analyzerResolutionButton.onClick = [this] { showAnalyzerResolutionMenu(); };
+
     auto setupStandardSlider = [&](juce::Slider& slider, juce::Label& label, const juce::String& labelText) {
         slider.setSliderStyle(juce::Slider::LinearHorizontal);
         slider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 80, 20);
@@ -146,6 +156,7 @@ MBRPAudioProcessorEditor::MBRPAudioProcessorEditor(MBRPAudioProcessor& p)
     updateReverbAttachments(currentSelectedBand);
     updateBandSpecificControls(currentSelectedBand);
     analyzerOverlay.setActiveBand(currentSelectedBand);
+    analyzerOverlay.setBandSpectrumSource(&analyzer.getAnalysisThread());
     // Увеличим высоту по умолчанию, чтобы вместить все контролы сверху
     setSize(900, 600); // Примерная высота, подберите по факту
 }
@@ -169,6 +180,7 @@ void MBRPAudioProcessorEditor::resized() {
     // --- 1. Верхняя панель (Название плагина "MBRP" и общий Bypass) ---
     auto titleArea = bounds.removeFromTop(titleBarHeight).reduced(padding, 0);
     bypassButton.setBounds(titleArea.removeFromRight(60).reduced(0, smallPadding / 2));
+    processingOptionsButton.setBounds(titleArea.removeFromRight(70).reduced(0, smallPadding / 2));
     bounds.removeFromTop(smallPadding);
 
     // --- Зона для контролов, которые располагаются над анализатором, когда он ВИДЕН ---
@@ -221,6 +233,10 @@ void MBRPAudioProcessorEditor::resized() {
         analyzerButtonSize, analyzerButtonSize);
     controlBar.analyzerButton.toFront(true);
 
+    // Разрешение анализатора - слева от кнопки анализатора
+    analyzerResolutionButton.setBounds(controlBar.analyzerButton.getBounds().translated(-(44 + smallPadding), 0).withWidth(44));
+    analyzerResolutionButton.toFront(false);
+
     if (analyzer.isVisible()) // Если анализатор должен быть виден
     {
         analyzer.setBounds(mainDisplayArea);
@@ -289,6 +305,7 @@ void MBRPAudioProcessorEditor::handleAnalyzerToggle(bool shouldBeOn)
     // Управляем видимостью компонентов
     analyzer.setVisible(shouldBeOn);
     analyzerOverlay.setVisible(shouldBeOn);
+    analyzerResolutionButton.setVisible(shouldBeOn);
 
     // Контролы кроссоверов и выбора полосы показываются, когда анализатор ВЫКЛЮЧЕН
     bool showAlternativeControls = !shouldBeOn;
@@ -311,6 +328,59 @@ void MBRPAudioProcessorEditor::handleAnalyzerToggle(bool shouldBeOn)
     resized();
 }
 
+void MBRPAudioProcessorEditor::showProcessingOptionsMenu()
+{
+    // Меню строится по параметрам: переключатель - пункт с галочкой, выбор - подменю
+    auto setFromEditor = [](juce::RangedAudioParameter& param, float normalisedValue) {
+        param.beginChangeGesture();
+        param.setValueNotifyingHost(normalisedValue);
+        param.endChangeGesture();
+        };
+
+    juce::PopupMenu menu;
+    for (const auto& id : MBRPAudioProcessor::getProcessingOptionIDs())
+    {
+        auto* param = processorRef.getAPVTS().getParameter(id);
+        if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(param))
+        {
+            juce::PopupMenu choices;
+            for (int i = 0; i < choice->choices.size(); ++i)
+                choices.addItem(choice->choices[i], true, choice->getIndex() == i,
+                    [choice, i, setFromEditor] { setFromEditor(*choice, choice->convertTo0to1((float)i)); });
+            menu.addSubMenu(choice->getName(64), choices);
+        }
+        else if (auto* toggle = dynamic_cast<juce::AudioParameterBool*>(param))
+        {
+            menu.addItem(toggle->getName(64), true, toggle->get(),
+                [toggle, setFromEditor] { setFromEditor(*toggle, toggle->get() ? 0.0f : 1.0f); });
+        }
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&processingOptionsButton));
+}
+
+void MBRPAudioProcessorEditor::showAnalyzerResolutionMenu()
+{
+    // Поток анализа перестраивает план FFT сам, отрисовка переходит с первым кадром нового размера
+    using Overlap = MBRP_GUI::SpectrumAnalysisThread::Overlap;
+    juce::Component::SafePointer<MBRPAudioProcessorEditor> safeThis(this); // Меню может пережить редактор
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("FFT Size");
+    for (auto order : { FFTOrder::order2048, FFTOrder::order4096, FFTOrder::order8192 })
+        menu.addItem(juce::String(1 << order), true, analyzer.getFFTOrder() == order,
+            [safeThis, order] { if (safeThis != nullptr) safeThis->analyzer.setFFTOrder(order); });
+
+    menu.addSectionHeader("Overlap");
+    const std::pair<Overlap, const char*> overlaps[] = {
+        { Overlap::half, "50%" }, { Overlap::threeQuarters, "75%" }, { Overlap::sevenEighths, "87.5%" } };
+    for (const auto& [overlap, name] : overlaps)
+        menu.addItem(name, true, analyzer.getOverlap() == overlap,
+            [safeThis, overlap = overlap] { if (safeThis != nullptr) safeThis->analyzer.setOverlap(overlap); });
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&analyzerResolutionButton));
+}
+
 void MBRPAudioProcessorEditor::timerCallback() {
     // Если анализатор не активен, нет смысла его обновлять.
     // Однако, анализатор сам имеет таймер, который им управляет.
@@ -41,6 +41,7 @@ private:
     // Компоненты GUI
     ControlBar controlBar;
     MBRP_GUI::SpectrumAnalyzer analyzer;
+    juce::TextButton analyzerResolutionButton; // Размер FFT и перекрытие анализатора
     MBRP_GUI::AnalyzerOverlay analyzerOverlay; // Будет принимать 3 параметра кроссовера
     MBRP_GUI::BandSelectControls bandSelectControls; // Будет иметь 4 кнопки
 
@@ -52,6 +53,7 @@ private:
     RotarySliderWithLabels panSlider;
     juce::Label panLabel;
     PowerButton bypassButton;
+    juce::TextButton processingOptionsButton; // Меню режимов обработки (см. MBRPAudioProcessor::getProcessingOptionIDs)
 
     // Контролы реверба
     RotarySliderWithLabels wetSlider;
@@ -87,6 +89,8 @@ private:
     void updateBandSpecificControls(int bandIndex);
     void handleBandAreaClick(int bandIndex);     // bandIndex 0..3
     void handleAnalyzerToggle(bool shouldBeOn);
+    void showProcessingOptionsMenu();
+    void showAnalyzerResolutionMenu();
 
     int currentSelectedBand = 0;
 
@@ -1,6 +1,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include <cmath>
+#include <algorithm>
 #include <vector>
 #include <memory>
 
@@ -197,6 +198,26 @@ juce::AudioProcessorValueTreeState::ParameterLayout MBRPAudioProcessor::createPa
     addBandControlParams("Mid-High", midHighGainID, midHighBypassID, midHighSoloID, midHighMuteID);
     addBandControlParams("High", highGainID, highBypassID, highSoloID, highMuteID);
 
+    // Режимы обработки (см. getProcessingOptionIDs): не автоматизируются, сохраняются в состоянии
+    layout.add(std::make_unique<AudioParameterBool>(
+        ParameterID{ "parallelProcessing", 1 }, "Parallel Processing", false,
+        AudioParameterBoolAttributes().withAutomatable(false)));
+    layout.add(std::make_unique<AudioParameterBool>(
+        ParameterID{ "pipelinedProcessing", 1 }, "Pipelined Processing", false,
+        AudioParameterBoolAttributes().withAutomatable(false)));
+    layout.add(std::make_unique<AudioParameterChoice>(
+        ParameterID{ "reverbMode", 1 }, "Reverb Mode", StringArray{ "Per Band", "Shared Space" }, 0, // Индекс - ReverbMode
+        AudioParameterChoiceAttributes().withAutomatable(false)));
+    layout.add(std::make_unique<AudioParameterChoice>(
+        ParameterID{ "crossoverMode", 1 }, "Crossover", StringArray{ "Cascade", "Linear Phase", "Biquad" }, 0, // Индекс - CrossoverMode
+        AudioParameterChoiceAttributes().withAutomatable(false)));
+    layout.add(std::make_unique<AudioParameterChoice>(
+        ParameterID{ "crossoverSlope", 1 }, "Biquad Slope", StringArray{ "LR2 (12 dB/oct)", "LR4 (24 dB/oct)", "LR8 (48 dB/oct)" }, 1, // Индекс - CrossoverSlope
+        AudioParameterChoiceAttributes().withAutomatable(false)));
+    layout.add(std::make_unique<AudioParameterBool>(
+        ParameterID{ "lowBandMultirate", 1 }, "Low Band Multirate", false,
+        AudioParameterBoolAttributes().withAutomatable(false)));
+
     return layout;
 }
 
@@ -226,86 +247,77 @@ MBRPAudioProcessor::MBRPAudioProcessor()
     bypassParameter = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("bypass"));
     jassert(bypassParameter != nullptr);
 
-    // Инициализация атомарных указателей на параметры реверба
-    lowWetParam = apvts->getRawParameterValue("lowWet");
-    lowSpaceParam = apvts->getRawParameterValue("lowSpace");
-    lowDistanceParam = apvts->getRawParameterValue("lowDistance");
-    lowDelayParam = apvts->getRawParameterValue("lowDelay");
-
-    lowMidWetParam = apvts->getRawParameterValue("lowMidWet");
-    lowMidSpaceParam = apvts->getRawParameterValue("lowMidSpace");
-    lowMidDistanceParam = apvts->getRawParameterValue("lowMidDistance");
-    lowMidDelayParam = apvts->getRawParameterValue("lowMidDelay");
-
-    midHighWetParam = apvts->getRawParameterValue("midHighWet");
-    midHighSpaceParam = apvts->getRawParameterValue("midHighSpace");
-    midHighDistanceParam = apvts->getRawParameterValue("midHighDistance");
-    midHighDelayParam = apvts->getRawParameterValue("midHighDelay");
-
-    highWetParam = apvts->getRawParameterValue("highWet");
-    highSpaceParam = apvts->getRawParameterValue("highSpace");
-    highDistanceParam = apvts->getRawParameterValue("highDistance");
-    highDelayParam = apvts->getRawParameterValue("highDelay");
-
-    // Инициализация указателей на параметры громкости, Bypass, Solo, Mute ---
-    lowGainParam = apvts->getRawParameterValue("lowGain");
-    lowBypassParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("lowBypass"));
-    lowSoloParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("lowSolo"));
-    lowMuteParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("lowMute"));
-    jassert(lowGainParam && lowBypassParam && lowSoloParam && lowMuteParam);
-
-    lowMidGainParam = apvts->getRawParameterValue("lowMidGain");
-    lowMidBypassParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("lowMidBypass"));
-    lowMidSoloParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("lowMidSolo"));
-    lowMidMuteParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("lowMidMute"));
-    jassert(lowMidGainParam && lowMidBypassParam && lowMidSoloParam && lowMidMuteParam);
-
-    midHighGainParam = apvts->getRawParameterValue("midHighGain");
-    midHighBypassParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("midHighBypass"));
-    midHighSoloParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("midHighSolo"));
-    midHighMuteParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("midHighMute"));
-    jassert(midHighGainParam && midHighBypassParam && midHighSoloParam && midHighMuteParam);
-
-    highGainParam = apvts->getRawParameterValue("highGain");
-    highBypassParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("highBypass"));
-    highSoloParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("highSolo"));
-    highMuteParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("highMute"));
-    jassert(highGainParam && highBypassParam && highSoloParam && highMuteParam);
+    // Режимы обработки
+    parallelProcessingParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("parallelProcessing"));
+    pipelinedProcessingParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("pipelinedProcessing"));
+    reverbModeParam = dynamic_cast<juce::AudioParameterChoice*>(apvts->getParameter("reverbMode"));
+    jassert(parallelProcessingParam != nullptr && pipelinedProcessingParam != nullptr);
+    crossoverModeParam = dynamic_cast<juce::AudioParameterChoice*>(apvts->getParameter("crossoverMode"));
+    crossoverSlopeParam = dynamic_cast<juce::AudioParameterChoice*>(apvts->getParameter("crossoverSlope"));
+    jassert(reverbModeParam != nullptr);
+    lowBandMultirateParam = dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter("lowBandMultirate"));
+    jassert(crossoverModeParam != nullptr && crossoverSlopeParam != nullptr && lowBandMultirateParam != nullptr);
+
+    // Инициализация указателей на параметры полос
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+    {
+        const juce::String prefix(bandParameterPrefixes[band]);
+        auto getBool = [this, &prefix](const char* suffix) { return dynamic_cast<juce::AudioParameterBool*>(apvts->getParameter(prefix + suffix)); };
+
+        wetParams[band] = apvts->getRawParameterValue(prefix + "Wet");
+        spaceParams[band] = apvts->getRawParameterValue(prefix + "Space");
+        distanceParams[band] = apvts->getRawParameterValue(prefix + "Distance");
+        delayParams[band] = apvts->getRawParameterValue(prefix + "Delay");
+        panParams[band] = apvts->getRawParameterValue(prefix + "Pan");
+        gainParams[band] = apvts->getRawParameterValue(prefix + "Gain");
+        bypassParams[band] = getBool("Bypass");
+        soloParams[band] = getBool("Solo");
+        muteParams[band] = getBool("Mute");
+        jassert(wetParams[band] && spaceParams[band] && distanceParams[band] && delayParams[band]);
+        jassert(panParams[band] && gainParams[band] && bypassParams[band] && soloParams[band] && muteParams[band]);
+    }
+
+    // Группы параметров для счетчиков изменений
+    parameterGroupByID["lowMidCrossover"] = crossoverGroup;
+    parameterGroupByID["midCrossover"] = crossoverGroup;
+    parameterGroupByID["midHighCrossover"] = crossoverGroup;
+    for (int band = 0; band < numBands; ++band)
+    {
+        const juce::String prefix(bandParameterPrefixes[(size_t)band]);
+        parameterGroupByID[prefix + "Pan"] = firstPanGroup + band;
+        parameterGroupByID[prefix + "Gain"] = firstGainGroup + band;
+        for (auto* suffix : { "Wet", "Space", "Distance", "Delay" })
+            parameterGroupByID[prefix + suffix] = firstReverbGroup + band;
+        parameterGroupByID[prefix + "Solo"] = soloGroup;
+    }
 
     // Добавление слушателей параметров
-    apvts->addParameterListener("bypass", this);
-    apvts->addParameterListener("lowMidCrossover", this);
-    apvts->addParameterListener("midCrossover", this);
-    apvts->addParameterListener("midHighCrossover", this);
+    for (const auto& id : getListenedParameterIDs())
+        apvts->addParameterListener(id, this);
+}
 
-    apvts->addParameterListener("lowPan", this);
-    apvts->addParameterListener("lowMidPan", this);
-    apvts->addParameterListener("midHighPan", this);
-    apvts->addParameterListener("highPan", this);
+juce::StringArray MBRPAudioProcessor::getListenedParameterIDs()
+{
+    juce::StringArray ids{ "bypass", "lowMidCrossover", "midCrossover", "midHighCrossover" };
+    for (auto* prefix : bandParameterPrefixes)
+        for (auto* suffix : { "Pan", "Gain", "Wet", "Space", "Distance", "Delay", "Solo", "Mute" })
+            ids.add(juce::String(prefix) + suffix);
+    ids.addArray(getProcessingOptionIDs());
+    return ids;
+}
 
-    // Слушатели для параметров Solo и Mute (Bypass и Gain обновляются в updateParameters) ---
-    apvts->addParameterListener("lowSolo", this); apvts->addParameterListener("lowMute", this);
-    apvts->addParameterListener("lowMidSolo", this); apvts->addParameterListener("lowMidMute", this);
-    apvts->addParameterListener("midHighSolo", this); apvts->addParameterListener("midHighMute", this);
-    apvts->addParameterListener("highSolo", this); apvts->addParameterListener("highMute", this);
+const juce::StringArray& MBRPAudioProcessor::getProcessingOptionIDs()
+{
+    static const juce::StringArray ids{ "parallelProcessing", "pipelinedProcessing", "reverbMode",
+                                        "crossoverMode", "crossoverSlope", "lowBandMultirate" };
+    return ids;
 }
 
 MBRPAudioProcessor::~MBRPAudioProcessor()
 {
-    apvts->removeParameterListener("bypass", this);
-    apvts->removeParameterListener("lowMidCrossover", this);
-    apvts->removeParameterListener("midCrossover", this);
-    apvts->removeParameterListener("midHighCrossover", this);
-    apvts->removeParameterListener("lowPan", this);
-    apvts->removeParameterListener("lowMidPan", this);
-    apvts->removeParameterListener("midHighPan", this);
-    apvts->removeParameterListener("highPan", this);
-
-    // Удаление слушателей для Solo и Mute ---
-    apvts->removeParameterListener("lowSolo", this); apvts->removeParameterListener("lowMute", this);
-    apvts->removeParameterListener("lowMidSolo", this); apvts->removeParameterListener("lowMidMute", this);
-    apvts->removeParameterListener("midHighSolo", this); apvts->removeParameterListener("midHighMute", this);
-    apvts->removeParameterListener("highSolo", this); apvts->removeParameterListener("highMute", this);
+    cancelPendingUpdate();
+    for (const auto& id : getListenedParameterIDs())
+        apvts->removeParameterListener(id, this);
 }
 
 
@@ -323,106 +335,132 @@ void MBRPAudioProcessor::changeProgramName(int index, const juce::String& newNam
 void MBRPAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     lastSampleRate = static_cast<float>(sampleRate);
+    preparedModes = getRequestedModes();
 
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
-    spec.numChannels = 1; // Фильтры кроссовера обрабатывают каждый канал отдельно
-
-    // Подготовка фильтров кроссовера
-    leftLowMidLPF.prepare(spec); rightLowMidLPF.prepare(spec);
-    leftMidLPF.prepare(spec);    rightMidLPF.prepare(spec);
-    leftMidHighLPF.prepare(spec); rightMidHighLPF.prepare(spec);
+    spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
 
-    leftLowMidLPF.reset(); rightLowMidLPF.reset();
-    leftMidLPF.reset();    rightMidLPF.reset();
-    leftMidHighLPF.reset(); rightMidHighLPF.reset();
+    // Рампы частот стартуют сразу с текущих значений (без скольжения)
+    using RampType = MBRP_DSP::ParameterRamp::Type;
+    const float initialCrossovers[] = { lowMidCrossover->get(), midCrossover->get(), midHighCrossover->get() };
+    for (size_t i = 0; i < crossoverRamps.size(); ++i)
+    {
+        crossoverRamps[i].prepare(sampleRate, samplesPerBlock, crossoverRampMs, RampType::exponential);
+        crossoverRamps[i].setCurrentAndTarget(initialCrossovers[i]);
+    }
 
-    // Подготовка буферов
+    // Подготовка кроссовера (коэффициенты сразу для текущих частот)
+    crossover.setCrossoverFrequencies(initialCrossovers[0], initialCrossovers[1], initialCrossovers[2]);
+    crossover.prepare(spec);
+    biquadCrossover.setSlope(getCrossoverSlope());
+    biquadCrossover.setCrossoverFrequencies(initialCrossovers[0], initialCrossovers[1], initialCrossovers[2]);
+    biquadCrossover.prepare(spec);
+    if (const auto mode = getCrossoverMode(); mode != CrossoverMode::linearPhase)
+        activeCrossoverMode = mode;
+
+    // Полосы: начальные значения параметров задаются до prepare(),
+    // поэтому рампы и сглаживание реверба стартуют сразу с них
+    parameterChanges.markAllChanged();
+    updateParameters(0);
+    bands.setReverbMode(preparedModes.sharedSpace ? ReverbMode::sharedSpace : ReverbMode::perBand);
+    bands.setLowBandMultirate(preparedModes.lowBandMultirate);
+
+    // Память пре-дилея - по верхней границе диапазона параметров на текущей частоте
+    float maxPreDelayMs = 0.0f;
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+        maxPreDelayMs = juce::jmax(maxPreDelayMs, apvts->getParameterRange(juce::String(bandParameterPrefixes[band]) + "Delay").end);
+    bands.setMaxPreDelay(maxPreDelayMs);
+    bands.prepare(spec);
     int numOutputChannels = getTotalNumOutputChannels();
-    lowBandBuffer.setSize(numOutputChannels, samplesPerBlock, false, true, true);
-    lowMidBandBuffer.setSize(numOutputChannels, samplesPerBlock, false, true, true);
-    midHighBandBuffer.setSize(numOutputChannels, samplesPerBlock, false, true, true);
-    highBandBuffer.setSize(numOutputChannels, samplesPerBlock, false, true, true);
-
-    tempFilterBuffer1.setSize(numOutputChannels, samplesPerBlock, false, true, true);
-    tempFilterBuffer2.setSize(numOutputChannels, samplesPerBlock, false, true, true);
-
-
-    setCopyToFifo(copyToFifo.load()); // Инициализация FIFO, если нужно
-
-    // Подготовка DSP объектов реверберации
-    spec.numChannels = getTotalNumOutputChannels(); // Реверб/микшер/задержка работают с полным количеством каналов
-
-    lowReverb.prepare(spec); lowReverb.reset();
-    lowMidReverb.prepare(spec); lowMidReverb.reset();
-    midHighReverb.prepare(spec); midHighReverb.reset();
-    highReverb.prepare(spec); highReverb.reset();
-
-    lowDelayLine.prepare(spec); lowDelayLine.reset();
-    lowMidDelayLine.prepare(spec); lowMidDelayLine.reset();
-    midHighDelayLine.prepare(spec); midHighDelayLine.reset();
-    highDelayLine.prepare(spec); highDelayLine.reset();
-
-    lowMixer.prepare(spec); lowMixer.reset();
-    lowMidMixer.prepare(spec); lowMidMixer.reset();
-    midHighMixer.prepare(spec); midHighMixer.reset();
-    highMixer.prepare(spec); highMixer.reset();
-
-    // Установка начальных параметров реверба (100% Wet внутри модуля реверба)
-    auto setupReverbParams = [&](juce::dsp::Reverb::Parameters& params, std::atomic<float>* space, std::atomic<float>* distance) {
-        params.wetLevel = 1.0f;
-        params.dryLevel = 0.0f;
-        params.width = 1.0f;
-        params.freezeMode = 0.0f;
-        // Загружаем начальные значения из атомарных указателей, если они уже инициализированы
-        params.roomSize = (space && space->load() >= 0.0f) ? space->load() : 0.5f;
-        params.damping = (distance && distance->load() >= 0.0f) ? distance->load() : 0.5f;
-    };
-    setupReverbParams(lowReverbParams, lowSpaceParam, lowDistanceParam); lowReverb.setParameters(lowReverbParams);
-    setupReverbParams(lowMidReverbParams, lowMidSpaceParam, lowMidDistanceParam); lowMidReverb.setParameters(lowMidReverbParams);
-    setupReverbParams(midHighReverbParams, midHighSpaceParam, midHighDistanceParam); midHighReverb.setParameters(midHighReverbParams);
-    setupReverbParams(highReverbParams, highSpaceParam, highDistanceParam); highReverb.setParameters(highReverbParams);
 
-    // Инициализация сглаженных значений
-    currentLowWet = lowWetParam ? lowWetParam->load() : 0.0f;
-    currentLowSpace = lowSpaceParam ? lowSpaceParam->load() : 0.5f;
-    currentLowDistance = lowDistanceParam ? lowDistanceParam->load() : 0.5f;
-    currentLowDelayMs = lowDelayParam ? lowDelayParam->load() : 0.0f;
+    // Конвейерный режим: второй комплект буферов полос, кадры входа и выхода
+    const bool stereo = getTotalNumInputChannels() == 2 && numOutputChannels == 2;
+    spectralActive = preparedModes.spectral && stereo;
+    pipelineActive = !spectralActive && preparedModes.pipelined && stereo;
+    linearPhaseActive = !spectralActive && preparedModes.linearPhase && stereo;
+    pipelineBlockSize = getPipelineLatencySamples(samplesPerBlock) / 2;
+    pipelineFill = 0;
+    pipelineInFlight = false;
+    if (pipelineActive)
+    {
+        for (auto& bandBuffer : pipelineBandBuffers)
+            bandBuffer.setSize(numOutputChannels, samplesPerBlock, false, true, true);
+        for (auto& frame : pipelineInputs)
+        {
+            frame.setSize(2, pipelineBlockSize, false, true, true);
+            frame.clear();
+        }
+        pipelineOutput.setSize(2, pipelineBlockSize, false, true, true);
+        pipelineOutput.clear();
+    }
+    if (spectralActive)
+        spectralSplitter.prepare(spec);
+    if (linearPhaseActive)
+        linearPhaseCrossover.prepare(spec, { initialCrossovers[0], initialCrossovers[1], initialCrossovers[2] });
+    else
+        linearPhaseCrossover.release(); // Фоновый поток расчета FIR нужен только в этом режиме
+    setLatencySamples(getActiveLatencySamples(samplesPerBlock)); // Вместе с режимами, которые ее задают
+
+    // Пул потоков - только для параллельного и конвейерного режимов
+    parallelActive = preparedModes.parallel;
+    if (parallelActive || pipelineActive)
+    {
+        if (workerPool == nullptr)
+            workerPool = std::make_unique<juce::SharedResourcePointer<MBRP_DSP::RealtimeThreadPool>>();
+    }
+    else
+    {
+        workerPool.reset();
+    }
+    minParallelBlockSize = parallelActive ? measureMinParallelBlockSize(samplesPerBlock)
+                                          : std::numeric_limits<int>::max();
 
-    currentLowMidWet = lowMidWetParam ? lowMidWetParam->load() : 0.0f;
-    currentLowMidSpace = lowMidSpaceParam ? lowMidSpaceParam->load() : 0.5f;
-    currentLowMidDistance = lowMidDistanceParam ? lowMidDistanceParam->load() : 0.5f;
-    currentLowMidDelayMs = lowMidDelayParam ? lowMidDelayParam->load() : 0.0f;
+    inputCapture.prepare(sampleRate, samplesPerBlock);
+    outputCapture.prepare(sampleRate, samplesPerBlock);
 
-    currentMidHighWet = midHighWetParam ? midHighWetParam->load() : 0.0f;
-    currentMidHighSpace = midHighSpaceParam ? midHighSpaceParam->load() : 0.5f;
-    currentMidHighDistance = midHighDistanceParam ? midHighDistanceParam->load() : 0.5f;
-    currentMidHighDelayMs = midHighDelayParam ? midHighDelayParam->load() : 0.0f;
+    // Множитель прореживания полосы - по верхней границе диапазона ее кроссовера
+    const float bandUpperEdges[] = { lowMidCrossover->range.end, midCrossover->range.end,
+                                     midHighCrossover->range.end, (float)(sampleRate / 2.0) };
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+        bandCaptures[band].prepare(sampleRate, samplesPerBlock,
+                                   MBRP_DSP::DecimatingCapture::chooseFactor(sampleRate, bandUpperEdges[band]));
 
-    currentHighWet = highWetParam ? highWetParam->load() : 0.0f;
-    currentHighSpace = highSpaceParam ? highSpaceParam->load() : 0.5f;
-    currentHighDistance = highDistanceParam ? highDistanceParam->load() : 0.5f;
-    currentHighDelayMs = highDelayParam ? highDelayParam->load() : 0.0f;
+    idleDetector.prepare(sampleRate);
+    preparedBlockSize = samplesPerBlock;
+}
 
+void MBRPAudioProcessor::releaseResources()
+{
+    linearPhaseCrossover.release();
+    preparedBlockSize = 0;
+}
 
-    // Установка начальных значений для задержек и микшеров
-    lowDelayLine.setDelay((currentLowDelayMs / 1000.0f) * lastSampleRate); lowMixer.setWetMixProportion(currentLowWet);
-    lowMidDelayLine.setDelay((currentLowMidDelayMs / 1000.0f) * lastSampleRate); lowMidMixer.setWetMixProportion(currentLowMidWet);
-    midHighDelayLine.setDelay((currentMidHighDelayMs / 1000.0f) * lastSampleRate); midHighMixer.setWetMixProportion(currentMidHighWet);
-    highDelayLine.setDelay((currentHighDelayMs / 1000.0f) * lastSampleRate); highMixer.setWetMixProportion(currentHighWet);
+MBRPAudioProcessor::ProcessingModes MBRPAudioProcessor::getRequestedModes() const
+{
+    ProcessingModes modes;
+    modes.parallel = parallelProcessingParam->get();
+    modes.pipelined = pipelinedProcessingParam->get();
+    modes.spectral = spectralRequested.load();
+    modes.linearPhase = getCrossoverMode() == CrossoverMode::linearPhase;
+    modes.sharedSpace = getReverbMode() == ReverbMode::sharedSpace;
+    modes.lowBandMultirate = lowBandMultirateParam->get();
+    return modes;
+}
 
-    // Подготовка DSP для громкости ---
-    lowBandGainDSP.prepare(spec); lowBandGainDSP.reset();
-    lowMidBandGainDSP.prepare(spec); lowMidBandGainDSP.reset();
-    midHighBandGainDSP.prepare(spec); midHighBandGainDSP.reset();
-    highBandGainDSP.prepare(spec); highBandGainDSP.reset();
+void MBRPAudioProcessor::handleAsyncUpdate()
+{
+    // Поток сообщений: обработка приостанавливается на время переподготовки
+    // (хост получает тишину), новая задержка сообщается из prepareToPlay
+    if (preparedBlockSize <= 0 || getRequestedModes() == preparedModes)
+        return;
 
-    updateParameters(); // Применяем все начальные значения параметров
+    suspendProcessing(true);
+    prepareToPlay((double)lastSampleRate, preparedBlockSize);
+    suspendProcessing(false);
 }
 
-void MBRPAudioProcessor::releaseResources() {}
-
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool MBRPAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
@@ -433,138 +471,71 @@ bool MBRPAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) cons
 }
 #endif
 
-void MBRPAudioProcessor::updateParameters()
-{
-    // Чтение актуальных значений параметров кроссовера
-    float lmcFreq = lowMidCrossover->get();
-    float mcFreq = midCrossover->get();
-    float mhcFreq = midHighCrossover->get();
-
-    // Коррекция частот кроссоверов для предотвращения инверсии
-    // Эта логика должна быть в parameterChanged, чтобы обновлять сами параметры,
-    // а здесь просто используем скорректированные значения.
-    // Для простоты пока оставим здесь, но лучше перенести в parameterChanged.
-    mcFreq = std::max(mcFreq, lmcFreq + MIN_CROSSOVER_SEPARATION);
-    mhcFreq = std::max(mhcFreq, mcFreq + MIN_CROSSOVER_SEPARATION);
-
-    // Применение (возможно, скорректированных локально) значений к фильтрам кроссовера
-    leftLowMidLPF.setCutoffFrequency(lmcFreq);   rightLowMidLPF.setCutoffFrequency(lmcFreq);
-    leftMidLPF.setCutoffFrequency(mcFreq);       rightMidLPF.setCutoffFrequency(mcFreq);
-    leftMidHighLPF.setCutoffFrequency(mhcFreq);  rightMidHighLPF.setCutoffFrequency(mhcFreq);
-
-    // Чтение актуальных значений параметров панорамы
-    float lowPanVal = apvts->getRawParameterValue("lowPan")->load();
-    float lowMidPanVal = apvts->getRawParameterValue("lowMidPan")->load();
-    float midHighPanVal = apvts->getRawParameterValue("midHighPan")->load();
-    float highPanVal = apvts->getRawParameterValue("highPan")->load();
-
-    // Расчет гейнов для панорамы
-    auto calculatePanGains = [](float panParam, std::atomic<float>& leftGain, std::atomic<float>& rightGain) {
-        constexpr float piOverTwo = juce::MathConstants<float>::pi * 0.5f;
-        float angle = (panParam * 0.5f + 0.5f) * piOverTwo;
-        leftGain.store(std::cos(angle));
-        rightGain.store(std::sin(angle));
-    };
-    calculatePanGains(lowPanVal, leftLowPanGain, rightLowPanGain);
-    calculatePanGains(lowMidPanVal, leftLowMidPanGain, rightLowMidPanGain);
-    calculatePanGains(midHighPanVal, leftMidHighPanGain, rightMidHighPanGain);
-    calculatePanGains(highPanVal, leftHighPanGain, rightHighPanGain);
-
-    // Обновление и сглаживание параметров реверба
-    const float smoothingFactor = 0.02f;
-    auto smoothAndUpdateParam = [&](float& currentValue, std::atomic<float>* targetParameterAtomicPtr) {
-        if (targetParameterAtomicPtr) {
-            currentValue = currentValue + smoothingFactor * (targetParameterAtomicPtr->load() - currentValue);
-        }
-    };
-
-    smoothAndUpdateParam(currentLowWet, lowWetParam);
-    smoothAndUpdateParam(currentLowSpace, lowSpaceParam);
-    smoothAndUpdateParam(currentLowDistance, lowDistanceParam);
-    smoothAndUpdateParam(currentLowDelayMs, lowDelayParam);
-
-    smoothAndUpdateParam(currentLowMidWet, lowMidWetParam);
-    smoothAndUpdateParam(currentLowMidSpace, lowMidSpaceParam);
-    smoothAndUpdateParam(currentLowMidDistance, lowMidDistanceParam);
-    smoothAndUpdateParam(currentLowMidDelayMs, lowMidDelayParam);
-
-    smoothAndUpdateParam(currentMidHighWet, midHighWetParam);
-    smoothAndUpdateParam(currentMidHighSpace, midHighSpaceParam);
-    smoothAndUpdateParam(currentMidHighDistance, midHighDistanceParam);
-    smoothAndUpdateParam(currentMidHighDelayMs, midHighDelayParam);
-
-    smoothAndUpdateParam(currentHighWet, highWetParam);
-    smoothAndUpdateParam(currentHighSpace, highSpaceParam);
-    smoothAndUpdateParam(currentHighDistance, highDistanceParam);
-    smoothAndUpdateParam(currentHighDelayMs, highDelayParam);
-
-    // Лямбда для обновления DSP объектов реверберации
-    auto updateReverbDSP = [&](juce::dsp::Reverb& reverb, juce::dsp::Reverb::Parameters& reverbModuleParams,
-        float smoothedSpace, float smoothedDistance,
-        juce::dsp::DelayLine<float>& delayLine, float smoothedDelayMs,
-        juce::dsp::DryWetMixer<float>& mixer, float smoothedWet)
+void MBRPAudioProcessor::updateParameters(int numSamples)
+{
+    // Кроссовер: новые цели рамп только при изменении частот
+    if (parameterChanges.consumeChange(crossoverGroup))
     {
-        reverbModuleParams.roomSize = smoothedSpace;
-        reverbModuleParams.damping = smoothedDistance;
-        reverb.setParameters(reverbModuleParams);
-
-        float delayInSamples = juce::jlimit(0.0f,
-            (float)delayLine.getMaximumDelayInSamples(),
-            (smoothedDelayMs / 1000.0f) * lastSampleRate);
-        delayLine.setDelay(delayInSamples);
-        mixer.setWetMixProportion(smoothedWet);
-    };
-
-    updateReverbDSP(lowReverb, lowReverbParams, currentLowSpace, currentLowDistance, lowDelayLine, currentLowDelayMs, lowMixer, currentLowWet);
-    updateReverbDSP(lowMidReverb, lowMidReverbParams, currentLowMidSpace, currentLowMidDistance, lowMidDelayLine, currentLowMidDelayMs, lowMidMixer, currentLowMidWet);
-    updateReverbDSP(midHighReverb, midHighReverbParams, currentMidHighSpace, currentMidHighDistance, midHighDelayLine, currentMidHighDelayMs, midHighMixer, currentMidHighWet);
-    updateReverbDSP(highReverb, highReverbParams, currentHighSpace, currentHighDistance, highDelayLine, currentHighDelayMs, highMixer, currentHighWet);
-
-    // Обновление DSP громкости ---
-    // Коэффициент сглаживания для громкости может быть другим, если нужно более быстрое реагирование
-    // Здесь используется Decibels::decibelsToGain для преобразования dB в линейный множитель
-    if (lowGainParam) lowBandGainDSP.setGainDecibels(lowGainParam->load());
-    if (lowMidGainParam) lowMidBandGainDSP.setGainDecibels(lowMidGainParam->load());
-    if (midHighGainParam) midHighBandGainDSP.setGainDecibels(midHighGainParam->load());
-    if (highGainParam) highBandGainDSP.setGainDecibels(highGainParam->load());
-    // --------------------------------------
-
-    // Обновление состояний Solo (вызывается из parameterChanged, но здесь для консистентности при запуске)
-    low_isSoloed.store(lowSoloParam ? lowSoloParam->get() : false);
-    lowMid_isSoloed.store(lowMidSoloParam ? lowMidSoloParam->get() : false);
-    midHigh_isSoloed.store(midHighSoloParam ? midHighSoloParam->get() : false);
-    high_isSoloed.store(highSoloParam ? highSoloParam->get() : false);
-    anySoloActive.store(low_isSoloed.load() || lowMid_isSoloed.load() || midHigh_isSoloed.load() || high_isSoloed.load());
-}
+        // Чтение актуальных значений параметров кроссовера
+        float lmcFreq = lowMidCrossover->get();
+        float mcFreq = midCrossover->get();
+        float mhcFreq = midHighCrossover->get();
+
+        // Коррекция частот кроссоверов для предотвращения инверсии
+        // (сами параметры корректируются в parameterChanged, здесь - страховка)
+        mcFreq = std::max(mcFreq, lmcFreq + MIN_CROSSOVER_SEPARATION);
+        mhcFreq = std::max(mhcFreq, mcFreq + MIN_CROSSOVER_SEPARATION);
+
+        crossoverRamps[0].setTarget(lmcFreq);
+        crossoverRamps[1].setTarget(mcFreq);
+        crossoverRamps[2].setTarget(mhcFreq);
+
+        // FIR сразу считаются для новых целей: рампу заменяет кроссфейд при смене фильтров
+        if (linearPhaseActive)
+            linearPhaseCrossover.setCrossoverFrequencies({ lmcFreq, mcFreq, mhcFreq });
+    }
 
-void MBRPAudioProcessor::pushNextSampleToFifo(const juce::AudioBuffer<float>& buffer, const int startChannel,
-    const int numChannels, juce::AbstractFifo& absFifo,
-    juce::AudioBuffer<float>& fifo)
-{
-    const int numSamples = buffer.getNumSamples();
-    // const int fifoSize = fifo.getNumSamples(); // Не используется напрямую
+    // Пока частоты скользят, коэффициенты считаются на конец каждого блока (3 x tan() на блок),
+    // внутри блока CrossoverEngine интерполирует их по отсчетам.
+    // Рампы с одинаковой постоянной времени сохраняют порядок частот.
+    if (std::any_of(crossoverRamps.begin(), crossoverRamps.end(), [](const auto& r) { return r.isRamping(); }))
+    {
+        const float lmcFreq = crossoverRamps[0].advance(numSamples);
+        const float mcFreq = crossoverRamps[1].advance(numSamples);
+        const float mhcFreq = crossoverRamps[2].advance(numSamples);
+        crossover.setCrossoverFrequencies(lmcFreq, mcFreq, mhcFreq);
+        biquadCrossover.setCrossoverFrequencies(lmcFreq, mcFreq, mhcFreq);
+    }
 
-    if (absFifo.getFreeSpace() < numSamples) return;
+    for (int band = 0; band < numBands; ++band)
+    {
+        const auto b = (size_t)band;
 
-    int start1, block1, start2, block2;
-    absFifo.prepareToWrite(numSamples, start1, block1, start2, block2);
+        if (parameterChanges.consumeChange(firstPanGroup + band))
+            bands.setPan(band, panParams[b]->load());
 
-    // Нормализуем start1 и start2 к размеру FIFO буфера, если он меньше чем totalSize abstractFifo
-    const int concreteFifoSize = fifo.getNumSamples();
-    start1 %= concreteFifoSize;
-    start2 %= concreteFifoSize;
+        if (parameterChanges.consumeChange(firstGainGroup + band))
+            bands.setGain(band, juce::Decibels::decibelsToGain(gainParams[b]->load()));
 
+        if (parameterChanges.consumeChange(firstReverbGroup + band))
+            bands.setReverb(band, wetParams[b]->load(), spaceParams[b]->load(), distanceParams[b]->load(), delayParams[b]->load());
+    }
 
-    if (block1 > 0) fifo.copyFrom(0, start1, buffer.getReadPointer(startChannel), block1);
-    if (block2 > 0) fifo.copyFrom(0, start2, buffer.getReadPointer(startChannel, block1), block2);
+    // Обновление состояний Solo (основное обновление в parameterChanged)
+    if (parameterChanges.consumeChange(soloGroup))
+        updateSoloStates();
+}
 
-    for (int channel = startChannel + 1; channel < startChannel + numChannels; ++channel) {
-        if (block1 > 0) fifo.addFrom(0, start1, buffer.getReadPointer(channel), block1);
-        if (block2 > 0) fifo.addFrom(0, start2, buffer.getReadPointer(channel, block1), block2);
+void MBRPAudioProcessor::updateSoloStates()
+{
+    bool anySoloed = false;
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+    {
+        const bool soloed = soloParams[band]->get();
+        bandSoloed[band].store(soloed);
+        anySoloed = anySoloed || soloed;
     }
-
-    absFifo.finishedWrite(block1 + block2);
-    nextFFTBlockReady.store(true);
+    anySoloActive.store(anySoloed);
 }
 
 void MBRPAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
@@ -575,170 +546,406 @@ void MBRPAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::Mi
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     jassert(totalNumInputChannels >= 1 && totalNumOutputChannels >= 1);
 
+    // Спектральный и конвейерный режимы: Bypass (и простой у конвейера) обрабатываются внутри
+    if (spectralActive || pipelineActive)
+    {
+        inputCapture.push(buffer, totalNumInputChannels);
+
+        if (spectralActive)
+            processBlockSpectral(buffer);
+        else
+            processBlockPipelined(buffer);
+
+        outputCapture.push(buffer, totalNumOutputChannels);
+        return;
+    }
+
     if (bypassParameter != nullptr && bypassParameter->get()) // Общий Bypass плагина
     {
-        if (copyToFifo.load())
+        // Линейно-фазовый кроссовер продолжает работать: сухой сигнал с его задержкой
+        if (linearPhaseActive && totalNumInputChannels == 2 && totalNumOutputChannels == 2)
         {
-            pushNextSampleToFifo(buffer, 0, totalNumInputChannels, abstractFifoInput, audioFifoInput);
-            pushNextSampleToFifo(buffer, 0, totalNumOutputChannels, abstractFifoOutput, audioFifoOutput);
+            const std::array<juce::AudioBuffer<float>*, numBands> bandBuffers{
+                &bands.getBandBuffer(0), &bands.getBandBuffer(1), &bands.getBandBuffer(2), &bands.getBandBuffer(3) };
+            splitBands(buffer.getArrayOfReadPointers(), bandBuffers, buffer.getNumSamples());
+            sumBandBuffers(bandBuffers, buffer, buffer.getNumSamples());
         }
+
+        inputCapture.push(buffer, totalNumInputChannels);
+        outputCapture.push(buffer, totalNumOutputChannels);
+        return;
+    }
+
+    // Простой: вход - цифровая тишина, хвосты уже затихли. DSP не трогаем, отдаем нули.
+    if (!idleDetector.beginBlock(buffer, totalNumInputChannels, buffer.getNumSamples()))
+    {
+        buffer.clear();
+        inputCapture.push(buffer, totalNumInputChannels);
+        outputCapture.push(buffer, totalNumOutputChannels);
         return;
     }
 
-    updateParameters();
+    updateParameters(buffer.getNumSamples());
 
-    if (copyToFifo.load())
-        pushNextSampleToFifo(buffer, 0, totalNumInputChannels, abstractFifoInput, audioFifoInput);
+    inputCapture.push(buffer, totalNumInputChannels);
 
     if (totalNumInputChannels == 2 && totalNumOutputChannels == 2)
     {
         auto numSamples = buffer.getNumSamples();
 
-        auto inputBlock = juce::dsp::AudioBlock<float>(buffer);
-        auto lowBandBlock = juce::dsp::AudioBlock<float>(lowBandBuffer).getSubBlock(0, numSamples);
-        auto lowMidBandBlock = juce::dsp::AudioBlock<float>(lowMidBandBuffer).getSubBlock(0, numSamples);
-        auto midHighBandBlock = juce::dsp::AudioBlock<float>(midHighBandBuffer).getSubBlock(0, numSamples);
-        auto highBandBlock = juce::dsp::AudioBlock<float>(highBandBuffer).getSubBlock(0, numSamples);
-        auto temp1Block = juce::dsp::AudioBlock<float>(tempFilterBuffer1).getSubBlock(0, numSamples);
-        auto temp2Block = juce::dsp::AudioBlock<float>(tempFilterBuffer2).getSubBlock(0, numSamples);
+        // 1. Разделение на "сырые" полосы: один проход по входу,
+        //    L и R обрабатываются в линиях SIMD-регистров,
+        //    результат пишется сразу в буферы полос
+        splitBands(buffer.getArrayOfReadPointers(),
+            { &bands.getBandBuffer(0), &bands.getBandBuffer(1), &bands.getBandBuffer(2), &bands.getBandBuffer(3) },
+            numSamples);
+        captureBands(numSamples);
+
+        // 2-3. Solo/Mute, реверб, гейн и панорама полос с суммированием в выход
+        processBands(buffer, numSamples);
 
-        // 1. Разделение на 4 "сырых" полосы
-        for (int ch = 0; ch < totalNumInputChannels; ++ch)
+        // 4. Вход тихий: ждем, пока хвосты всех полос опустятся ниже -120 dBFS, затем простой
+        if (idleDetector.isDraining())
         {
-            // ... (код разделения на полосы, как и раньше) ...
-            auto inputChannelBlock = inputBlock.getSingleChannelBlock(ch);
-            auto lowChannelBlock = lowBandBlock.getSingleChannelBlock(ch);
-            auto lowMidChannelBlock = lowMidBandBlock.getSingleChannelBlock(ch);
-            auto midHighChannelBlock = midHighBandBlock.getSingleChannelBlock(ch);
-            auto highChannelBlock = highBandBlock.getSingleChannelBlock(ch);
-            auto temp1ChannelBlock = temp1Block.getSingleChannelBlock(ch);
-            auto temp2ChannelBlock = temp2Block.getSingleChannelBlock(ch);
-            auto& lpfLowMid = (ch == 0) ? leftLowMidLPF : rightLowMidLPF;
-            auto& lpfMid = (ch == 0) ? leftMidLPF : rightMidLPF;
-            auto& lpfMidHigh = (ch == 0) ? leftMidHighLPF : rightMidHighLPF;
-
-            lowChannelBlock.copyFrom(inputChannelBlock);
-            juce::dsp::ProcessContextReplacing<float> lowCtx(lowChannelBlock);
-            lpfLowMid.process(lowCtx);
-
-            temp1ChannelBlock.copyFrom(inputChannelBlock);
-            juce::dsp::ProcessContextReplacing<float> temp1Ctx(temp1ChannelBlock);
-            lpfMid.process(temp1Ctx);
-
-            lowMidChannelBlock.copyFrom(temp1ChannelBlock);
-            lowMidChannelBlock.subtract(lowChannelBlock);
-
-            temp2ChannelBlock.copyFrom(inputChannelBlock);
-            juce::dsp::ProcessContextReplacing<float> temp2Ctx(temp2ChannelBlock);
-            lpfMidHigh.process(temp2Ctx);
-
-            midHighChannelBlock.copyFrom(temp2ChannelBlock);
-            midHighChannelBlock.subtract(temp1ChannelBlock);
-
-            highChannelBlock.copyFrom(inputChannelBlock);
-            highChannelBlock.subtract(temp2ChannelBlock);
+            const int pendingSamples = bands.getMaxPendingDelaySamples() + (linearPhaseActive ? linearPhaseCrossover.getLatencySamples() : 0);
+            if (idleDetector.endBlock(buffer, totalNumOutputChannels, numSamples, pendingSamples))
+                resetBandProcessing();
         }
+    }
+    else // Обработка для других конфигураций каналов
+    {
+        for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+            buffer.clear(i, 0, buffer.getNumSamples());
+    }
+
+    outputCapture.push(buffer, totalNumOutputChannels);
+}
+
+void MBRPAudioProcessor::processBlockPipelined(juce::AudioBuffer<float>& buffer)
+{
+    // Блок хоста любого размера режется на кадры pipelineBlockSize.
+    // Вход пишется в текущий кадр, выход читается из кадра, готового на прошлом шаге,
+    // поэтому задержка постоянна: кадр на накопление + кадр в конвейере.
+    const int numSamples = buffer.getNumSamples();
+    auto& input = pipelineInputs[0];
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int count = std::min(numSamples - pos, pipelineBlockSize - pipelineFill);
 
-        // 2. Применение SOLO и MUTE к "сырым" полосам
-        auto applySoloMuteToRawBand =
-            [&](juce::dsp::AudioBlock<float>& rawBandBlock,
-                std::atomic<bool>& isSoloed, juce::AudioParameterBool* muteParam)
+        for (int ch = 0; ch < 2; ++ch)
         {
-            bool isCurrentlyMuted = (muteParam && muteParam->get());
-            bool shouldBeSilentDueToSolo = anySoloActive.load() && !isSoloed.load();
-            if (isCurrentlyMuted || shouldBeSilentDueToSolo) {
-                rawBandBlock.clear();
+            input.copyFrom(ch, pipelineFill, buffer, ch, pos, count);
+            buffer.copyFrom(ch, pos, pipelineOutput, ch, pipelineFill, count);
+        }
+
+        pipelineFill += count;
+        pos += count;
+
+        if (pipelineFill == pipelineBlockSize)
+        {
+            runPipelineStep();
+            pipelineFill = 0;
+        }
+    }
+}
+
+void MBRPAudioProcessor::runPipelineStep()
+{
+    const int frameSize = pipelineBlockSize;
+    auto& input = pipelineInputs[0];
+    auto& previousInput = pipelineInputs[1];
+
+    if (bypassParameter != nullptr && bypassParameter->get() && linearPhaseActive)
+    {
+        // Сухой сигнал с задержкой конвейера и кроссовера: полосы идут по конвейеру без обработки
+        const std::array<juce::AudioBuffer<float>*, numBands> inFlight{
+            &bands.getBandBuffer(0), &bands.getBandBuffer(1), &bands.getBandBuffer(2), &bands.getBandBuffer(3) };
+        if (pipelineInFlight)
+            sumBandBuffers(inFlight, pipelineOutput, frameSize);
+        else
+            pipelineOutput.clear();
+
+        splitBands(input.getArrayOfReadPointers(),
+            { &pipelineBandBuffers[0], &pipelineBandBuffers[1], &pipelineBandBuffers[2], &pipelineBandBuffers[3] },
+            frameSize);
+        for (int band = 0; band < numBands; ++band)
+            std::swap(bands.getBandBuffer(band), pipelineBandBuffers[(size_t)band]);
+        pipelineInFlight = true;
+    }
+    else if (bypassParameter != nullptr && bypassParameter->get())
+    {
+        // Сухой сигнал с той же задержкой, что и обработанный
+        for (int ch = 0; ch < 2; ++ch)
+            pipelineOutput.copyFrom(ch, 0, previousInput, ch, 0, frameSize);
+        pipelineInFlight = false;
+    }
+    else if (!idleDetector.beginBlock(input, 2, frameSize))
+    {
+        // Простой: кадр в конвейере тоже тихий (см. задержку в endBlock ниже)
+        pipelineOutput.clear();
+        pipelineInFlight = false;
+    }
+    else
+    {
+        updateParameters(frameSize);
+
+        // Кроссовер нового кадра (в pipelineBandBuffers) и обработка полос прошлого кадра
+        // (в буферах BandProcessor) не делят состояния и идут параллельно.
+        // Вложенный parallelFor внутри processBands выполнится последовательно.
+        auto stage = [this, frameSize, &input](int job)
+        {
+            if (job == 0)
+            {
+                splitBands(input.getArrayOfReadPointers(),
+                    { &pipelineBandBuffers[0], &pipelineBandBuffers[1], &pipelineBandBuffers[2], &pipelineBandBuffers[3] },
+                    frameSize);
+            }
+            else if (pipelineInFlight)
+            {
+                processBands(pipelineOutput, frameSize);
+            }
+            else
+            {
+                pipelineOutput.clear();
             }
         };
-        applySoloMuteToRawBand(lowBandBlock, low_isSoloed, lowMuteParam);
-        applySoloMuteToRawBand(lowMidBandBlock, lowMid_isSoloed, lowMidMuteParam);
-        applySoloMuteToRawBand(midHighBandBlock, midHigh_isSoloed, midHighMuteParam);
-        applySoloMuteToRawBand(highBandBlock, high_isSoloed, highMuteParam);
-
-        // 3. Обработка каждой полосы (Реверб, Гейн, Панорама с учетом Bypass)
-
-        // Лямбда для реверберации (без изменений)
-        auto applyReverbToBand =
-            [&](juce::dsp::AudioBlock<float>& bandBlock,
-                juce::dsp::DryWetMixer<float>& mixer,
-                juce::dsp::DelayLine<float>& delayLine,
-                juce::dsp::Reverb& reverb)
+        if (auto* pool = getWorkerPool())
+            pool->parallelFor(2, stage);
+        else
+            for (int job = 0; job < 2; ++job)
+                stage(job);
+
+        if (idleDetector.isDraining())
         {
-            mixer.pushDrySamples(bandBlock);
-            juce::dsp::ProcessContextReplacing<float> wetContext(bandBlock);
-            delayLine.process(wetContext);
-            reverb.process(wetContext);
-            mixer.mixWetSamples(bandBlock);
-        };
+            // Кадр, оставшийся в конвейере, - еще frameSize отсчетов хвоста
+            const int pendingSamples = bands.getMaxPendingDelaySamples() + frameSize
+                                     + (linearPhaseActive ? linearPhaseCrossover.getLatencySamples() : 0);
+            if (idleDetector.endBlock(pipelineOutput, 2, frameSize, pendingSamples))
+                resetBandProcessing();
+        }
 
-        // Массивы для удобного доступа к DSP объектам и параметрам в цикле
-        juce::dsp::AudioBlock<float>* bandBlocks[] = { &lowBandBlock, &lowMidBandBlock, &midHighBandBlock, &highBandBlock };
-        juce::AudioParameterBool* bypassParams[] = { lowBypassParam, lowMidBypassParam, midHighBypassParam, highBypassParam };
-        juce::dsp::Reverb* reverbs[] = { &lowReverb, &lowMidReverb, &midHighReverb, &highReverb };
-        juce::dsp::DryWetMixer<float>* mixers[] = { &lowMixer, &lowMidMixer, &midHighMixer, &highMixer };
-        juce::dsp::DelayLine<float>* delayLines[] = { &lowDelayLine, &lowMidDelayLine, &midHighDelayLine, &highDelayLine };
-        juce::dsp::Gain<float>* gainDSPs[] = { &lowBandGainDSP, &lowMidBandGainDSP, &midHighBandGainDSP, &highBandGainDSP };
-
-        // Для панорамы нам понадобятся указатели на atomic<float> для левого и правого каналов
-        struct PanGains { std::atomic<float>* left; std::atomic<float>* right; };
-        PanGains panGainAtomics[] = {
-            {&leftLowPanGain, &rightLowPanGain},
-            {&leftLowMidPanGain, &rightLowMidPanGain},
-            {&leftMidHighPanGain, &rightMidHighPanGain},
-            {&leftHighPanGain, &rightHighPanGain}
-        };
+        // Разделенный кадр становится кадром в конвейере (перестановка без копирования)
+        for (int band = 0; band < numBands; ++band)
+            std::swap(bands.getBandBuffer(band), pipelineBandBuffers[(size_t)band]);
+        captureBands(frameSize);
+        pipelineInFlight = true;
+    }
+
+    std::swap(input, previousInput);
+}
+
+void MBRPAudioProcessor::setPipelinedProcessing(bool shouldBePipelined)
+{
+    // Режим и задержка применяются при переподготовке (см. handleAsyncUpdate)
+    pipelinedProcessingParam->setValueNotifyingHost(shouldBePipelined ? 1.0f : 0.0f);
+}
 
+void MBRPAudioProcessor::setSpectralProcessing(bool shouldBeSpectral)
+{
+    // Как и конвейер: режим и задержка применяются при переподготовке (см. handleAsyncUpdate)
+    spectralRequested = shouldBeSpectral;
+    triggerAsyncUpdate();
+}
 
-        buffer.clear(); // Очищаем выходной буфер перед суммированием
+void MBRPAudioProcessor::setCrossoverMode(CrossoverMode newMode)
+{
+    // cascade/biquad - со следующего блока; linearPhase - при переподготовке (см. handleAsyncUpdate)
+    crossoverModeParam->setValueNotifyingHost(crossoverModeParam->convertTo0to1((float)static_cast<int>(newMode)));
+}
 
-        for (int i = 0; i < 4; ++i) // Итерация по 4 полосам
+int MBRPAudioProcessor::getActiveLatencySamples(int samplesPerBlock) const
+{
+    if (spectralActive)
+        return spectralSplitter.getLatencySamples();
+
+    const int crossoverLatency = linearPhaseActive ? MBRP_DSP::LinearPhaseCrossover::getLatencySamples(lastSampleRate) : 0;
+    return crossoverLatency + (pipelineActive ? getPipelineLatencySamples(samplesPerBlock) : 0);
+}
+
+void MBRPAudioProcessor::processBlockSpectral(juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    updateParameters(numSamples);
+
+    // Границы полос - текущие (сглаженные) частоты кроссовера
+    std::array<float, MBRP_DSP::CrossoverEngine::numSplits> edges;
+    for (size_t i = 0; i < edges.size(); ++i)
+        edges[i] = crossoverRamps[i].getCurrentValue();
+    spectralSplitter.setBandEdges(edges.data(), numBands);
+
+    // Гейны полос в спектре. Общий Bypass - единичные гейны: STFT восстанавливает вход
+    // с той же задержкой, поэтому переключение не сдвигает сигнал.
+    // Резкие смены гейна сглаживает перекрытие кадров.
+    const bool pluginBypassed = bypassParameter != nullptr && bypassParameter->get();
+    const bool soloActive = anySoloActive.load();
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+    {
+        float left = 1.0f, right = 1.0f;
+        if (!pluginBypassed)
         {
-            juce::dsp::AudioBlock<float>& currentBandBlock = *bandBlocks[i];
-            bool isBandBypassed = (bypassParams[i] && bypassParams[i]->get());
+            const bool silenced = muteParams[band]->get() || (soloActive && !bandSoloed[band].load());
+            const float gain = silenced ? 0.0f : juce::Decibels::decibelsToGain(gainParams[band]->load());
 
-            // --- Применение эффектов, если полоса НЕ в байпасе ---
-            if (!isBandBypassed)
+            if (bypassParams[band]->get())
             {
-                // 3.1 Применяем реверберацию
-                applyReverbToBand(currentBandBlock, *mixers[i], *delayLines[i], *reverbs[i]);
-            }
-            // Если в байпасе, реверберация пропускается. Сигнал остается "сухим" (после S/M).
-
-            // 3.2 Применяем Гейн (громкость) в любом случае (к "сухому" или "мокрому" сигналу)
-            juce::dsp::ProcessContextReplacing<float> gainCtx(currentBandBlock);
-            gainDSPs[i]->process(gainCtx);
-
-            // 3.3 Суммирование в выходной буфер с применением панорамы
-            // Панорама применяется только если полоса НЕ в байпасе.
-            // Если в байпасе, то сигнал добавляется "как есть" (центральная панорама, т.е. L=R=сигнал_полосы).
-            const auto* leftBandIn = currentBandBlock.getChannelPointer(0);
-            const auto* rightBandIn = currentBandBlock.getChannelPointer(1);
-            auto* leftOut = buffer.getWritePointer(0);
-            auto* rightOut = buffer.getWritePointer(1);
-
-            float currentLeftPanGain = 1.0f; // По умолчанию для байпаса или если нет панорамы
-            float currentRightPanGain = 1.0f;
-
-            if (!isBandBypassed) {
-                currentLeftPanGain = panGainAtomics[i].left->load();
-                currentRightPanGain = panGainAtomics[i].right->load();
+                left = right = gain; // Байпас полосы: без панорамы
             }
-
-            for (int sample = 0; sample < numSamples; ++sample)
+            else
             {
-                leftOut[sample] += leftBandIn[sample] * currentLeftPanGain;
-                rightOut[sample] += rightBandIn[sample] * currentRightPanGain;
+                MBRP_DSP::BandProcessor<numBands>::getPanGains(panParams[band]->load(), left, right);
+                left *= gain;
+                right *= gain;
             }
         }
+        spectralSplitter.setBandGains((int)band, left, right);
     }
-    else // Обработка для других конфигураций каналов
+
+    spectralSplitter.process(buffer.getArrayOfWritePointers(), numSamples);
+}
+
+int MBRPAudioProcessor::getPipelineLatencySamples(int samplesPerBlock)
+{
+    // Кадр - половина блока хоста, поэтому полная задержка (2 кадра) не больше одного блока
+    return 2 * std::max(1, samplesPerBlock / 2);
+}
+
+void MBRPAudioProcessor::splitBands(const float* const* input,
+                                    const std::array<juce::AudioBuffer<float>*, numBands>& bandBuffers, int numSamples)
+{
+    if (linearPhaseActive)
     {
-        for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-            buffer.clear(i, 0, buffer.getNumSamples());
+        std::array<float* const*, numBands> bandChannels;
+        for (size_t band = 0; band < bandChannels.size(); ++band)
+            bandChannels[band] = bandBuffers[band]->getArrayOfWritePointers();
+        linearPhaseCrossover.processStereo(input, bandChannels, numSamples);
+        return;
+    }
+
+    // Смена кроссовера: новый стартует с чистого состояния (короткий переходный процесс).
+    // linearPhase без prepareToPlay еще не активен - остается прежний кроссовер.
+    if (const auto mode = getCrossoverMode();
+        mode != activeCrossoverMode && mode != CrossoverMode::linearPhase)
+    {
+        if (mode == CrossoverMode::biquad)
+            biquadCrossover.reset();
+        else
+            crossover.reset();
+        activeCrossoverMode = mode;
     }
 
-    if (copyToFifo.load())
-        pushNextSampleToFifo(buffer, 0, totalNumOutputChannels, abstractFifoOutput, audioFifoOutput);
+    if (activeCrossoverMode == CrossoverMode::biquad)
+    {
+        std::array<float* const*, numBands> bandChannels;
+        for (size_t band = 0; band < bandChannels.size(); ++band)
+            bandChannels[band] = bandBuffers[band]->getArrayOfWritePointers();
+
+        biquadCrossover.setSlope(getCrossoverSlope());
+        biquadCrossover.processStereo(input, bandChannels, numSamples);
+    }
+    else
+    {
+        crossover.processStereo(input,
+            bandBuffers[0]->getArrayOfWritePointers(), bandBuffers[1]->getArrayOfWritePointers(),
+            bandBuffers[2]->getArrayOfWritePointers(), bandBuffers[3]->getArrayOfWritePointers(),
+            numSamples);
+    }
+}
+
+void MBRPAudioProcessor::sumBandBuffers(const std::array<juce::AudioBuffer<float>*, numBands>& bandBuffers,
+                                        juce::AudioBuffer<float>& output, int numSamples)
+{
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        output.copyFrom(ch, 0, *bandBuffers[0], ch, 0, numSamples);
+        for (size_t band = 1; band < bandBuffers.size(); ++band)
+            output.addFrom(ch, 0, *bandBuffers[band], ch, 0, numSamples);
+    }
+}
+
+void MBRPAudioProcessor::captureBands(int numSamples)
+{
+    // Неотображаемые полосы стоят в DecimatingCapture::push() на одной проверке
+    for (int band = 0; band < numBands; ++band)
+        bandCaptures[(size_t)band].push(bands.getBandBuffer(band), numSamples);
+}
+
+void MBRPAudioProcessor::processBands(juce::AudioBuffer<float>& output, int numSamples)
+{
+    // Переключатели полос не сглаживаются и читаются каждый блок
+    const bool soloActive = anySoloActive.load();
+    for (size_t band = 0; band < (size_t)numBands; ++band)
+    {
+        const bool muted = muteParams[band]->get();
+        bands.setSilenced((int)band, muted || (soloActive && !bandSoloed[band].load()));
+        bands.setBypassed((int)band, bypassParams[band]->get());
+    }
+
+    // 2-3. Solo/Mute, реверб, гейн и панорама полос с суммированием в выход.
+    //      На достаточно длинных блоках сети реверба идут параллельно в пуле рабочих потоков.
+    bands.process(output, numSamples, shouldProcessInParallel(numSamples) ? getWorkerPool() : nullptr);
+}
+
+bool MBRPAudioProcessor::shouldProcessInParallel(int numSamples) const
+{
+    return parallelActive
+        && numSamples >= minParallelBlockSize
+        && numSamples <= bands.getMaximumBlockSize();
+}
+
+int MBRPAudioProcessor::measureMinParallelBlockSize(int samplesPerBlock)
+{
+    // Параллельно выгодно, только если сеть реверба одного канала считается дольше, чем
+    // будится рабочий поток: иначе вызывающий поток успевает посчитать обе сети сам, и раздача
+    // лишь добавляет свою стоимость. Запас 2x - чтобы выигрыш был заметен на фоне кручения
+    // потоков. Оба времени замеряются на этой машине (сеть - линейна по числу отсчетов).
+    // Порядок величин: сеть ~0.05 мкс на отсчет (~25 мкс на 512), раздача крутящимся потокам
+    // ~0.2 мкс, уснувшим - от десятков мкс, т.е. порог обычно - сотни отсчетов.
+    constexpr double speedupMargin = 2.0;
+
+    auto* pool = getWorkerPool();
+    if (pool == nullptr || pool->getNumWorkers() == 0)
+        return std::numeric_limits<int>::max();
+
+    const double dispatchUs = pool->measureDispatchMicroseconds();
+    const double networkUsPerSample = bands.measureReverbNetworkMicroseconds(samplesPerBlock) / juce::jmax(1, samplesPerBlock);
+    if (networkUsPerSample <= 0.0)
+        return std::numeric_limits<int>::max();
+
+    const double threshold = std::ceil(speedupMargin * dispatchUs / networkUsPerSample);
+    return threshold >= (double)std::numeric_limits<int>::max() ? std::numeric_limits<int>::max()
+                                                                : juce::jmax(1, (int)threshold);
+}
+
+void MBRPAudioProcessor::setLowBandMultirate(bool shouldBeMultirate)
+{
+    lowBandMultirateParam->setValueNotifyingHost(shouldBeMultirate ? 1.0f : 0.0f);
+}
+
+void MBRPAudioProcessor::setCrossoverSlope(CrossoverSlope newSlope)
+{
+    crossoverSlopeParam->setValueNotifyingHost(crossoverSlopeParam->convertTo0to1((float)static_cast<int>(newSlope)));
+}
+
+void MBRPAudioProcessor::setReverbMode(ReverbMode newMode)
+{
+    // Движок и его память меняются при переподготовке (см. handleAsyncUpdate)
+    reverbModeParam->setValueNotifyingHost(reverbModeParam->convertTo0to1((float)static_cast<int>(newMode)));
+}
+
+void MBRPAudioProcessor::setParallelProcessing(bool shouldBeParallel)
+{
+    parallelProcessingParam->setValueNotifyingHost(shouldBeParallel ? 1.0f : 0.0f);
+}
+
+void MBRPAudioProcessor::resetBandProcessing()
+{
+    // Сброс всего состояния обработки (хвосты уже затихли, так что щелчков нет)
+    crossover.reset();
+    biquadCrossover.reset();
+    if (linearPhaseActive)
+        linearPhaseCrossover.reset();
+    bands.reset();
 }
 
 bool MBRPAudioProcessor::hasEditor() const { return true; }
@@ -765,7 +972,7 @@ void MBRPAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
             editorSize.setX(apvts->state.getProperty("editorSizeX", editorSize.getX()));
             editorSize.setY(apvts->state.getProperty("editorSizeY", editorSize.getY()));
             if (auto* editor = getActiveEditor()) editor->setSize(editorSize.x, editorSize.y);
-            updateParameters(); // Применяем загруженные параметры
+            parameterChanges.markAllChanged(); // Применятся в следующем processBlock (аудиопоток)
         }
     }
 }
@@ -774,6 +981,15 @@ void MBRPAudioProcessor::parameterChanged(const juce::String& parameterID, float
 {
     juce::ignoreUnused(newValue); // newValue уже применен к параметру
 
+    // Отмечаем группу как изменившуюся - аудиопоток пересчитает только её
+    auto groupIt = parameterGroupByID.find(parameterID);
+    if (groupIt != parameterGroupByID.end())
+        parameterChanges.markChanged(groupIt->second);
+
+    // Режимы обработки, которые требуют prepareToPlay, - переподготовка в потоке сообщений
+    if (getProcessingOptionIDs().contains(parameterID))
+        triggerAsyncUpdate();
+
     if (isInternallySettingCrossoverParam.load()) return; // Предотвращение рекурсии
 
     // Логика коррекции частот кроссоверов
@@ -845,12 +1061,7 @@ void MBRPAudioProcessor::parameterChanged(const juce::String& parameterID, float
     // Если изменился один из параметров Solo
     if (parameterID.contains("Solo")) {
         // Обновляем состояния solo для DSP
-        low_isSoloed.store(lowSoloParam->get());
-        lowMid_isSoloed.store(lowMidSoloParam->get());
-        midHigh_isSoloed.store(midHighSoloParam->get());
-        high_isSoloed.store(highSoloParam->get());
-
-        anySoloActive.store(low_isSoloed.load() || lowMid_isSoloed.load() || midHigh_isSoloed.load() || high_isSoloed.load());
+        updateSoloStates();
 
         // Если активировали Solo на одной полосе, нужно убедиться, что другие Solo выключены,
         // если мы хотим эксклюзивное солирование.
@@ -867,27 +1078,11 @@ void MBRPAudioProcessor::parameterChanged(const juce::String& parameterID, float
 
 void MBRPAudioProcessor::setCopyToFifo(bool _copyToFifo)
 {
-    if (_copyToFifo != copyToFifo.load()) {
-        copyToFifo.store(_copyToFifo);
-        if (_copyToFifo) {
-            const int fifoSizeSamples = fftSize * 2;
-            abstractFifoInput.setTotalSize(fifoSizeSamples);
-            abstractFifoOutput.setTotalSize(fifoSizeSamples);
-            // Размер audioFifoInput/Output должен быть равен fifoSizeSamples, а не 1 каналу
-            // Иначе в pushNextSampleToFifo будет выход за пределы, если start1/start2 > 0
-            audioFifoInput.setSize(1, fifoSizeSamples); // Канал 1, но размер fifoSizeSamples
-            audioFifoOutput.setSize(1, fifoSizeSamples); // Канал 1, но размер fifoSizeSamples
-
-            abstractFifoInput.reset();
-            abstractFifoOutput.reset();
-            audioFifoInput.clear();
-            audioFifoOutput.clear();
-            DBG("FIFO Copying Enabled. Abstract FIFO size: " << fifoSizeSamples << ", Concrete FIFO samples: " << audioFifoInput.getNumSamples());
-        }
-        else {
-            DBG("FIFO Copying Disabled.");
-        }
-    }
+    // Память колец не трогается: читатель может работать в любой момент
+    inputCapture.setEnabled(_copyToFifo);
+    outputCapture.setEnabled(_copyToFifo);
+    for (auto& capture : bandCaptures)
+        capture.setEnabled(_copyToFifo);
 }
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter() {
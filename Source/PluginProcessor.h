@@ -3,10 +3,24 @@
 #include <JuceHeader.h>
 #include <juce_dsp/juce_dsp.h> // <<< ДОБАВИТЬ
 #include <atomic>
+#include <limits>
 #include <memory>
+#include <unordered_map>
+#include "DSP/BiquadCrossover.h"
+#include "DSP/CaptureRing.h"
+#include "DSP/DecimatingCapture.h"
+#include "DSP/CrossoverEngine.h"
+#include "DSP/BandProcessor.h"
+#include "DSP/IdleDetector.h"
+#include "DSP/LinearPhaseCrossover.h"
+#include "DSP/ParameterChangeTracker.h"
+#include "DSP/ParameterRamp.h"
+#include "DSP/RealtimeThreadPool.h"
+#include "DSP/SpectralBandSplitter.h"
 
 //==============================================================================
-class MBRPAudioProcessor : public juce::AudioProcessor, public juce::AudioProcessorValueTreeState::Listener
+class MBRPAudioProcessor : public juce::AudioProcessor, public juce::AudioProcessorValueTreeState::Listener,
+                           private juce::AsyncUpdater
 {
 public:
     MBRPAudioProcessor();
@@ -45,47 +59,14 @@ public:
     juce::AudioParameterFloat* midCrossover{ nullptr };
     juce::AudioParameterFloat* midHighCrossover{ nullptr };
 
-    // --- Атомарные указатели на параметры реверба ---
-    std::atomic<float>* lowWetParam = nullptr;
-    std::atomic<float>* lowSpaceParam = nullptr;
-    std::atomic<float>* lowDistanceParam = nullptr;
-    std::atomic<float>* lowDelayParam = nullptr;
-
-    std::atomic<float>* lowMidWetParam = nullptr;
-    std::atomic<float>* lowMidSpaceParam = nullptr;
-    std::atomic<float>* lowMidDistanceParam = nullptr;
-    std::atomic<float>* lowMidDelayParam = nullptr;
-
-    std::atomic<float>* midHighWetParam = nullptr;
-    std::atomic<float>* midHighSpaceParam = nullptr;
-    std::atomic<float>* midHighDistanceParam = nullptr;
-    std::atomic<float>* midHighDelayParam = nullptr;
-
-    std::atomic<float>* highWetParam = nullptr;
-    std::atomic<float>* highSpaceParam = nullptr;
-    std::atomic<float>* highDistanceParam = nullptr;
-    std::atomic<float>* highDelayParam = nullptr;
-
-    // Параметры громкости, Bypass, Solo, Mute (атомарные указатели) ---
-    std::atomic<float>* lowGainParam = nullptr;
-    std::atomic<float>* lowMidGainParam = nullptr;
-    std::atomic<float>* midHighGainParam = nullptr;
-    std::atomic<float>* highGainParam = nullptr;
-
-    juce::AudioParameterBool* lowBypassParam = nullptr; 
-    juce::AudioParameterBool* lowMidBypassParam = nullptr;
-    juce::AudioParameterBool* midHighBypassParam = nullptr;
-    juce::AudioParameterBool* highBypassParam = nullptr;
-
-    juce::AudioParameterBool* lowSoloParam = nullptr;
-    juce::AudioParameterBool* lowMidSoloParam = nullptr;
-    juce::AudioParameterBool* midHighSoloParam = nullptr;
-    juce::AudioParameterBool* highSoloParam = nullptr;
-
-    juce::AudioParameterBool* lowMuteParam = nullptr;
-    juce::AudioParameterBool* lowMidMuteParam = nullptr;
-    juce::AudioParameterBool* midHighMuteParam = nullptr;
-    juce::AudioParameterBool* highMuteParam = nullptr;
+    // --- Полосы: число задает кроссовер, параметры полосы - префикс + суффикс ("lowWet", "highPan") ---
+    static constexpr int numBands = MBRP_DSP::CrossoverEngine::numBands;
+    static constexpr std::array<const char*, numBands> bandParameterPrefixes{ "low", "lowMid", "midHigh", "high" };
+
+    // --- Атомарные указатели на параметры полос (индекс - номер полосы) ---
+    std::array<std::atomic<float>*, numBands> wetParams{}, spaceParams{}, distanceParams{}, delayParams{};
+    std::array<std::atomic<float>*, numBands> panParams{}, gainParams{};
+    std::array<juce::AudioParameterBool*, numBands> bypassParams{}, soloParams{}, muteParams{};
 
     // Listener для параметров
     void parameterChanged(const juce::String& parameterID, float newValue) override;
@@ -96,74 +77,204 @@ public:
     // --- Члены для Анализатора Спектра ---
     static constexpr int fftOrder = 11;
     static constexpr int fftSize = 1 << fftOrder;
-    std::atomic<bool> nextFFTBlockReady{ false };
-    juce::AbstractFifo abstractFifoInput{ fftSize * 2 };
-    juce::AudioBuffer<float> audioFifoInput;
-    juce::AbstractFifo abstractFifoOutput{ fftSize * 2 };
-    juce::AudioBuffer<float> audioFifoOutput;
+    // Стерео-захват входа и выхода для анализатора (память - в prepareToPlay, читатель - поток анализа).
+    // Без читателя дольше CaptureRing::consumerTimeoutSeconds захват сам останавливается.
+    MBRP_DSP::CaptureRing inputCapture, outputCapture;
+    // Отводы полос сразу после кроссовера, нижние - с понижением частоты (см. DecimatingCapture).
+    // В спектральном режиме буферов полос нет, и отводы молчат.
+    std::array<MBRP_DSP::DecimatingCapture, numBands> bandCaptures;
     void setCopyToFifo(bool _copyToFifo);
 
-    bool isCopyToFifoEnabled() const { return copyToFifo.load(); }
+    bool isCopyToFifoEnabled() const { return outputCapture.isEnabled(); }
     juce::Point<int> getSavedEditorSize() const { return editorSize; }
     void setSavedEditorSize(const juce::Point<int>& size) { editorSize = size; }
 
     juce::AudioParameterBool* bypassParameter{ nullptr };
+
+    // --- Режимы обработки: неавтоматизируемые параметры, сохраняются в состоянии APVTS ---
+    // Редактор показывает их в меню настроек. Режимы, которые требуют памяти, потоков
+    // или меняют задержку, применяются в prepareToPlay; смена параметра переподготавливает
+    // обработку в потоке сообщений (handleAsyncUpdate).
+    static const juce::StringArray& getProcessingOptionIDs();
+
+    // Параллельная обработка сетей реверба в общем пуле потоков (см. RealtimeThreadPool).
+    // По умолчанию выключена: пул и его потоки создаются только для включенного режима.
+    void setParallelProcessing(bool shouldBeParallel);
+    bool isParallelProcessingEnabled() const { return parallelProcessingParam->get(); }
+
+    // Конвейерный режим: кроссовер блока N в аудиопотоке, полосы блока N-1 - в пуле потоков.
+    // Добавляет getPipelineLatencySamples() задержки; режим и задержка применяются вместе в prepareToPlay.
+    void setPipelinedProcessing(bool shouldBePipelined);
+    bool isPipelinedProcessingEnabled() const { return pipelinedProcessingParam->get(); }
+    static int getPipelineLatencySamples(int samplesPerBlock);
+
+    // Движок реверба: полная сеть на полосу или общее пространство (см. SharedSpaceReverb).
+    // Параметр "reverbMode" (индекс - ReverbMode). Применяется при переподготовке (см. handleAsyncUpdate):
+    // память выделяется только под выбранный движок, хвосты прежнего обрываются.
+    using ReverbMode = MBRP_DSP::ReverbMode;
+    void setReverbMode(ReverbMode newMode);
+    ReverbMode getReverbMode() const { return static_cast<ReverbMode>(reverbModeParam->getIndex()); }
+
+    // Кроссовер: каскад LPF с вычитанием (CrossoverEngine), линейно-фазовый FIR
+    // (LinearPhaseCrossover) или биквады с выбираемой крутизной LR2/LR4/LR8 (BiquadCrossover).
+    // Дерева (TreeCrossover) здесь нет: на 4 полосах оно делает те же 3 разделения, что и каскад,
+    // плюс компенсацию фазы, и обходится примерно вдвое дороже; оно для раскладок от 8 полос.
+    // Параметр "crossoverMode" (индекс - CrossoverMode). Переключение между cascade и biquad -
+    // на следующем блоке. linearPhase добавляет задержку и, как спектральный режим, включается
+    // и выключается вместе с ней в prepareToPlay.
+    enum class CrossoverMode { cascade = 0, linearPhase, biquad };
+    void setCrossoverMode(CrossoverMode newMode);
+    CrossoverMode getCrossoverMode() const { return static_cast<CrossoverMode>(crossoverModeParam->getIndex()); }
+
+    // Крутизна режима biquad: LR2 - дешевле для живых сетапов, LR8 - для мастеринга.
+    // Смена - на следующем блоке, состояние фильтров сбрасывается.
+    // Параметр "crossoverSlope" (индекс - CrossoverSlope).
+    using CrossoverSlope = MBRP_DSP::CrossoverSlope;
+    void setCrossoverSlope(CrossoverSlope newSlope);
+    CrossoverSlope getCrossoverSlope() const { return static_cast<CrossoverSlope>(crossoverSlopeParam->getIndex()); }
+
+    // Спектральный режим: полосы делит STFT (SpectralBandSplitter), гейн, панорама и Solo/Mute
+    // применяются прямо в спектре, пре-дилей и реверб полос не используются.
+    // Добавляет задержку в fftSize отсчетов; режим и задержка применяются вместе в prepareToPlay.
+    // Не параметр и не пункт меню Options: границы полос - те же 4 полосы кроссовера, а регуляторы
+    // Wet/Space/Distance/Delay в этом режиме ничего не делают. Пользовательским режим станет,
+    // когда у процессора будет свое число спектральных полос (16-32) и редактор это отразит.
+    void setSpectralProcessing(bool shouldBeSpectral);
+    bool isSpectralProcessingEnabled() const { return spectralRequested.load(); }
+
+    // Low полоса на пониженной частоте (4x-8x, см. BandProcessor::setLowBandMultirate), только с Per Band.
+    // Полноскоростной пре-дилей и линия реверба Low полосы тогда не выделяются и не считаются;
+    // CPU реверба падает, когда реверб есть у одной Low полосы, иначе - немного выше.
+    // Задержку плагина не меняет, применяется в prepareToPlay (параметр "lowBandMultirate").
+    void setLowBandMultirate(bool shouldBeMultirate);
+    bool isLowBandMultirateEnabled() const { return lowBandMultirateParam->get(); }
 private:
     std::unique_ptr<juce::AudioProcessorValueTreeState> apvts;
 
-    // --- Фильтры и обработка ---
-    using Filter = juce::dsp::LinkwitzRileyFilter<float>;
-    Filter leftLowMidLPF, rightLowMidLPF;   // LPF для отделения Low от LowMid+MidHigh+High
-    Filter leftMidLPF, rightMidLPF;         // LPF для отделения Low+LowMid от MidHigh+High (на основе входа)
-    Filter leftMidHighLPF, rightMidHighLPF; // LPF для отделения Low+LowMid+MidHigh от High (на основе входа)
+    // --- Кроссовер: все полосы за один проход по входу ---
+    MBRP_DSP::CrossoverEngine crossover;
+    MBRP_DSP::BiquadCrossover biquadCrossover;
+    juce::AudioParameterChoice* crossoverSlopeParam{ nullptr };
+    juce::AudioParameterChoice* crossoverModeParam{ nullptr };
+    CrossoverMode activeCrossoverMode = CrossoverMode::cascade; // Только поток, делящий полосы
+    MBRP_DSP::LinearPhaseCrossover linearPhaseCrossover;
+    bool linearPhaseActive = false; // Фиксируется в prepareToPlay
 
+    // Вход (L/R) -> буферы полос выбранным кроссовером
+    void splitBands(const float* const* input, const std::array<juce::AudioBuffer<float>*, numBands>& bandBuffers, int numSamples);
 
-    std::atomic<float> leftLowPanGain{ 1.f }, rightLowPanGain{ 1.f };
-    std::atomic<float> leftLowMidPanGain{ 1.f }, rightLowMidPanGain{ 1.f };
-    std::atomic<float> leftMidHighPanGain{ 1.f }, rightMidHighPanGain{ 1.f };
-    std::atomic<float> leftHighPanGain{ 1.f }, rightHighPanGain{ 1.f };
+    // Сумма буферов полос без обработки: при линейно-фазовом кроссовере это вход с его задержкой
+    // (общий Bypass не сдвигает сигнал)
+    static void sumBandBuffers(const std::array<juce::AudioBuffer<float>*, numBands>& bandBuffers,
+                               juce::AudioBuffer<float>& output, int numSamples);
 
-    // Буферы для разделения на полосы
-    juce::AudioBuffer<float> lowBandBuffer;      // Полоса Low
-    juce::AudioBuffer<float> lowMidBandBuffer;   // Полоса Low-Mid
-    juce::AudioBuffer<float> midHighBandBuffer;  // Полоса Mid-High
-    juce::AudioBuffer<float> highBandBuffer;     // Полоса High
+    // Буферы полос BandProcessor (только что разделенные) -> bandCaptures
+    void captureBands(int numSamples);
 
-    // Вспомогательные буферы для фильтрации
-    juce::AudioBuffer<float> tempFilterBuffer1; // Для результата LPF(midCrossover)
-    juce::AudioBuffer<float> tempFilterBuffer2; // Для результата LPF(midHighCrossover)
 
+    // --- Сглаживание частот кроссовера по отсчетам (см. ParameterRamp) ---
+    // Рампы параметров полос - внутри BandProcessor.
+    static constexpr float crossoverRampMs = 30.0f;  // exponential, частота среза в Гц
+    std::array<MBRP_DSP::ParameterRamp, MBRP_DSP::CrossoverEngine::numSplits> crossoverRamps;
 
-    // --- Управление FIFO ---
-    std::atomic<bool> copyToFifo{ false };
-    void pushNextSampleToFifo(const juce::AudioBuffer<float>& buffer, int startChannel, int numChannels,
-        juce::AbstractFifo& absFifo, juce::AudioBuffer<float>& fifo);
-
-    float lastSampleRate = 44100.0f;
-    juce::Point<int> editorSize = { 2000, 1020 }; // Увеличил высоту по умолчанию
+    // --- Solo/Mute, пре-дилей, реверб, гейн и панорама всех полос ---
+    MBRP_DSP::BandProcessor<numBands> bands;
 
-    void updateParameters();
 
-    // --- DSP объекты реверберации для каждой полосы ---
-    juce::dsp::Reverb lowReverb, lowMidReverb, midHighReverb, highReverb;
-    juce::dsp::DelayLine<float> lowDelayLine{ 44100 * 2 }, lowMidDelayLine{ 44100 * 2 }, midHighDelayLine{ 44100 * 2 }, highDelayLine{ 44100 * 2 };
-    juce::dsp::DryWetMixer<float> lowMixer, lowMidMixer, midHighMixer, highMixer;
-    juce::dsp::Reverb::Parameters lowReverbParams, lowMidReverbParams, midHighReverbParams, highReverbParams;
 
-    // --- Переменные для сглаженных значений реверба ---
-    float currentLowWet = 0.0f, currentLowSpace = 0.5f, currentLowDistance = 0.5f, currentLowDelayMs = 0.0f;
-    float currentLowMidWet = 0.0f, currentLowMidSpace = 0.5f, currentLowMidDistance = 0.5f, currentLowMidDelayMs = 0.0f;
-    float currentMidHighWet = 0.0f, currentMidHighSpace = 0.5f, currentMidHighDistance = 0.5f, currentMidHighDelayMs = 0.0f;
-    float currentHighWet = 0.0f, currentHighSpace = 0.5f, currentHighDistance = 0.5f, currentHighDelayMs = 0.0f;
+    float lastSampleRate = 44100.0f;
+    juce::Point<int> editorSize = { 2000, 1020 }; // Увеличил высоту по умолчанию
 
+    void updateParameters(int numSamples);
+
+    // --- Группы параметров со счетчиками изменений (см. ParameterChangeTracker) ---
+    // updateParameters() задает новые цели рамп только для изменившихся групп;
+    // дальше значения доходят до цели по отсчетам (ParameterRamp).
+    enum ParameterGroup
+    {
+        crossoverGroup = 0,
+        firstPanGroup,                                // + индекс полосы
+        firstGainGroup = firstPanGroup + numBands,    // + индекс полосы
+        firstReverbGroup = firstGainGroup + numBands, // Wet/Space/Distance/Pre-Delay, + индекс полосы
+        soloGroup = firstReverbGroup + numBands,
+        numParameterGroups
+    };
+    MBRP_DSP::ParameterChangeTracker<numParameterGroups> parameterChanges;
+    std::unordered_map<juce::String, int> parameterGroupByID; // Заполняется в конструкторе, дальше только чтение
+    static juce::StringArray getListenedParameterIDs();
+
+    juce::AudioParameterChoice* reverbModeParam{ nullptr };
+    juce::AudioParameterBool* lowBandMultirateParam{ nullptr };
 
     std::atomic<bool> isInternallySettingCrossoverParam{ false };
 
-    juce::dsp::Gain<float> lowBandGainDSP, lowMidBandGainDSP, midHighBandGainDSP, highBandGainDSP;
-
-    // Состояния Solo/Mute для DSP логики
-    std::atomic<bool> low_isSoloed{ false }, lowMid_isSoloed{ false }, midHigh_isSoloed{ false }, high_isSoloed{ false };
+    // Состояния Solo для DSP логики
+    std::array<std::atomic<bool>, numBands> bandSoloed{};
     std::atomic<bool> anySoloActive{ false }; // Флаг, что хотя бы одна полоса солируется
+    void updateSoloStates();
+
+    // Простой всего плагина при тишине на входе и затихших хвостах
+    MBRP_DSP::IdleDetector idleDetector;
+    void resetBandProcessing();
+
+    // --- Режимы, зафиксированные в prepareToPlay ---
+    struct ProcessingModes
+    {
+        bool parallel = false;
+        bool pipelined = false;
+        bool spectral = false;
+        bool linearPhase = false; // crossoverMode == linearPhase
+        bool sharedSpace = false; // reverbMode == sharedSpace
+        bool lowBandMultirate = false;
+
+        bool operator==(const ProcessingModes& other) const noexcept
+        {
+            return parallel == other.parallel && pipelined == other.pipelined && spectral == other.spectral
+                && linearPhase == other.linearPhase && sharedSpace == other.sharedSpace
+                && lowBandMultirate == other.lowBandMultirate;
+        }
+        bool operator!=(const ProcessingModes& other) const noexcept { return !(*this == other); }
+    };
+    ProcessingModes getRequestedModes() const; // Из параметров
+    ProcessingModes preparedModes;
+    int preparedBlockSize = 0;                 // 0 - не подготовлен (или releaseResources)
+    void handleAsyncUpdate() override;         // Переподготовка при смене режима
+
+    // Один пул рабочих потоков на все экземпляры плагина в процессе; держится, только
+    // пока его использует включенный режим
+    std::unique_ptr<juce::SharedResourcePointer<MBRP_DSP::RealtimeThreadPool>> workerPool;
+    MBRP_DSP::RealtimeThreadPool* getWorkerPool() const noexcept { return workerPool != nullptr ? &workerPool->getObject() : nullptr; }
+
+    juce::AudioParameterBool* parallelProcessingParam{ nullptr };
+    bool parallelActive = false;
+    int minParallelBlockSize = std::numeric_limits<int>::max(); // Короче - обработка в аудиопотоке хоста
+    int measureMinParallelBlockSize(int samplesPerBlock);
+    bool shouldProcessInParallel(int numSamples) const;
+
+    // --- Конвейерный режим: двойная буферизация буферов полос ---
+    juce::AudioParameterBool* pipelinedProcessingParam{ nullptr };
+    bool pipelineActive = false;           // Фиксируется в prepareToPlay
+    int pipelineBlockSize = 0;             // Размер кадра конвейера
+    int pipelineFill = 0;                  // Заполнено отсчетов текущего кадра
+    bool pipelineInFlight = false;         // В буферах полос BandProcessor лежит необработанный кадр
+    std::array<juce::AudioBuffer<float>, numBands> pipelineBandBuffers; // Второй комплект буферов полос
+    std::array<juce::AudioBuffer<float>, 2> pipelineInputs;      // Текущий и предыдущий кадры входа
+    juce::AudioBuffer<float> pipelineOutput;                     // Выход кадра, готового на прошлом шаге
+    void processBlockPipelined(juce::AudioBuffer<float>& buffer);
+    void runPipelineStep();
+
+    // --- Спектральный режим (вместо конвейера и обработки полос во временной области) ---
+    std::atomic<bool> spectralRequested{ false }; // Не сохраняется в состоянии
+    bool spectralActive = false; // Фиксируется в prepareToPlay
+    MBRP_DSP::SpectralBandSplitter spectralSplitter{ fftOrder };
+    void processBlockSpectral(juce::AudioBuffer<float>& buffer);
+
+    // Задержка режимов, зафиксированных в prepareToPlay: спектральный или конвейерный
+    // плюс линейно-фазовый кроссовер
+    int getActiveLatencySamples(int samplesPerBlock) const;
+
+    // Переключатели полос (Bypass/Solo/Mute, движок реверба) и обработка полос с суммированием в output
+    void processBands(juce::AudioBuffer<float>& output, int numSamples);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MBRPAudioProcessor)
 };